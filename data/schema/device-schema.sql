@@ -58,7 +58,9 @@ CREATE TABLE device_%deviceid_songs (
   effective_albumartist TEXT,
   effective_originalyear INTEGER NOT NULL DEFAULT 0,
 
-  cue_path TEXT
+  cue_path TEXT,
+
+  duplicate_key INTEGER
 
 );
 
@@ -66,6 +68,8 @@ CREATE INDEX idx_device_%deviceid_songs_album ON device_%deviceid_songs (album);
 
 CREATE INDEX idx_device_%deviceid_songs_comp_artist ON device_%deviceid_songs (compilation_effective, artist);
 
+CREATE INDEX idx_device_%deviceid_songs_duplicate_key ON device_%deviceid_songs (duplicate_key, unavailable);
+
 CREATE VIRTUAL TABLE device_%deviceid_fts USING fts3(
   ftstitle, ftsalbum, ftsartist, ftsalbumartist, ftscomposer, ftsperformer, ftsgrouping, ftsgenre, ftscomment,
   tokenize=unicode
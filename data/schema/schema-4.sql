@@ -0,0 +1,8 @@
+CREATE TABLE IF NOT EXISTS fingerprints (
+  filename TEXT PRIMARY KEY,
+  mtime INTEGER NOT NULL,
+  filesize INTEGER NOT NULL,
+  fingerprint TEXT NOT NULL
+);
+
+UPDATE schema_version SET version=4;
@@ -0,0 +1,20 @@
+CREATE TABLE IF NOT EXISTS albums (
+  album TEXT NOT NULL,
+  effective_albumartist TEXT NOT NULL,
+  compilation INTEGER NOT NULL DEFAULT 0,
+  artist TEXT NOT NULL,
+  albumartist TEXT NOT NULL,
+  art_automatic TEXT,
+  art_manual TEXT,
+  filename TEXT NOT NULL,
+  songs INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE INDEX IF NOT EXISTS idx_albums_album ON albums (album);
+
+CREATE INDEX IF NOT EXISTS idx_albums_comp_artist ON albums (compilation, effective_albumartist);
+
+INSERT INTO albums (album, effective_albumartist, compilation, artist, albumartist, art_automatic, art_manual, filename, songs)
+SELECT album, CASE WHEN compilation_effective THEN '' ELSE IFNULL(effective_albumartist, '') END AS album_effective_albumartist, compilation_effective, CASE WHEN compilation_effective THEN '' ELSE artist END, CASE WHEN compilation_effective THEN '' ELSE albumartist END, art_automatic, art_manual, MIN(filename), COUNT(*) FROM songs WHERE unavailable = 0 GROUP BY album, album_effective_albumartist, compilation_effective;
+
+UPDATE schema_version SET version=5;
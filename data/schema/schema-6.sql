@@ -0,0 +1,11 @@
+DROP VIEW IF EXISTS duplicated_songs;
+
+ALTER TABLE songs ADD COLUMN duplicate_key INTEGER;
+
+ALTER TABLE %alldevicesongstables ADD COLUMN duplicate_key INTEGER;
+
+CREATE INDEX IF NOT EXISTS idx_duplicate_key ON songs (duplicate_key, unavailable);
+
+CREATE INDEX IF NOT EXISTS idx_%alldevicesongstables_duplicate_key ON %alldevicesongstables (duplicate_key, unavailable);
+
+UPDATE schema_version SET version=6;
@@ -0,0 +1,13 @@
+CREATE TABLE IF NOT EXISTS art_thumbnails (
+  hash INTEGER PRIMARY KEY,
+  thumbnail BLOB NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS songs_art_thumbnails (
+  filename TEXT PRIMARY KEY,
+  hash INTEGER NOT NULL
+);
+
+CREATE INDEX IF NOT EXISTS idx_songs_art_thumbnails_hash ON songs_art_thumbnails (hash);
+
+UPDATE schema_version SET version=7;
@@ -0,0 +1,7 @@
+CREATE TABLE IF NOT EXISTS changed_albums (
+  album TEXT PRIMARY KEY
+);
+
+INSERT OR IGNORE INTO changed_albums (album) SELECT DISTINCT album FROM songs WHERE unavailable = 0 AND album != '';
+
+UPDATE schema_version SET version=8;
@@ -4,7 +4,7 @@ CREATE TABLE IF NOT EXISTS schema_version (
 
 DELETE FROM schema_version;
 
-INSERT INTO schema_version (version) VALUES (3);
+INSERT INTO schema_version (version) VALUES (8);
 
 CREATE TABLE IF NOT EXISTS directories (
   path TEXT NOT NULL,
@@ -66,7 +66,9 @@ CREATE TABLE IF NOT EXISTS songs (
   effective_albumartist TEXT,
   effective_originalyear INTEGER NOT NULL DEFAULT 0,
 
-  cue_path TEXT
+  cue_path TEXT,
+
+  duplicate_key INTEGER
 
 );
 
@@ -149,6 +151,39 @@ CREATE TABLE IF NOT EXISTS devices (
   transcode_format NOT NULL DEFAULT 5
 );
 
+CREATE TABLE IF NOT EXISTS fingerprints (
+  filename TEXT PRIMARY KEY,
+  mtime INTEGER NOT NULL,
+  filesize INTEGER NOT NULL,
+  fingerprint TEXT NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS albums (
+  album TEXT NOT NULL,
+  effective_albumartist TEXT NOT NULL,
+  compilation INTEGER NOT NULL DEFAULT 0,
+  artist TEXT NOT NULL,
+  albumartist TEXT NOT NULL,
+  art_automatic TEXT,
+  art_manual TEXT,
+  filename TEXT NOT NULL,
+  songs INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE TABLE IF NOT EXISTS art_thumbnails (
+  hash INTEGER PRIMARY KEY,
+  thumbnail BLOB NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS songs_art_thumbnails (
+  filename TEXT PRIMARY KEY,
+  hash INTEGER NOT NULL
+);
+
+CREATE TABLE IF NOT EXISTS changed_albums (
+  album TEXT PRIMARY KEY
+);
+
 CREATE INDEX IF NOT EXISTS idx_filename ON songs (filename);
 
 CREATE INDEX IF NOT EXISTS idx_comp_artist ON songs (compilation_effective, artist);
@@ -157,7 +192,13 @@ CREATE INDEX IF NOT EXISTS idx_album ON songs (album);
 
 CREATE INDEX IF NOT EXISTS idx_title ON songs (title);
 
-CREATE VIEW IF NOT EXISTS duplicated_songs as select artist dup_artist, album dup_album, title dup_title from songs as inner_songs where artist != '' and album != '' and title != '' and unavailable = 0 group by artist, album , title having count(*) > 1;
+CREATE INDEX IF NOT EXISTS idx_duplicate_key ON songs (duplicate_key, unavailable);
+
+CREATE INDEX IF NOT EXISTS idx_albums_album ON albums (album);
+
+CREATE INDEX IF NOT EXISTS idx_albums_comp_artist ON albums (compilation, effective_albumartist);
+
+CREATE INDEX IF NOT EXISTS idx_songs_art_thumbnails_hash ON songs_art_thumbnails (hash);
 
 CREATE VIRTUAL TABLE IF NOT EXISTS songs_fts USING fts3(
 
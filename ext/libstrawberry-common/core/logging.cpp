@@ -32,6 +32,10 @@
 #include <stdlib.h>
 #include <string>
 #include <iostream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #ifdef Q_OS_UNIX
   #include <execinfo.h>
 #endif
@@ -43,6 +47,22 @@ namespace logging {
 static Level sDefaultLevel = Level_Debug;
 static QMap<QString, Level>* sClassLevels = nullptr;
 static QIODevice *sNullDevice = nullptr;
+static std::mutex sLevelsMutex;
+
+std::atomic<int> sLevelsGeneration(1);
+
+// Formatted lines are pushed onto a lock-free stack by the logging threads and written out in order by a background thread.
+struct PendingLine {
+  QByteArray data;
+  PendingLine *next;
+};
+
+static std::atomic<PendingLine*> sPendingLines(nullptr);
+static std::atomic<bool> sWriterStopping(false);
+static std::thread *sWriterThread = nullptr;
+static std::mutex sWriterMutex;
+static std::condition_variable sWriterCondition;
+static std::mutex sOutputMutex;
 
 //const char* kDefaultLogLevels = "*:3";
 const char* kDefaultLogLevels = "GstEnginePipeline:2,*:3";
@@ -67,10 +87,81 @@ void GLog(const char *domain, int level, const char *message, void *user_data) {
 
 }
 
+static void FlushPendingLines() {
+
+  std::lock_guard<std::mutex> l(sOutputMutex);
+
+  PendingLine *line = sPendingLines.exchange(nullptr, std::memory_order_acquire);
+
+  // The stack holds the newest line first.
+  PendingLine *ordered = nullptr;
+  while (line) {
+    PendingLine *next = line->next;
+    line->next = ordered;
+    ordered = line;
+    line = next;
+  }
+
+  if (!ordered) return;
+
+  while (ordered) {
+    PendingLine *next = ordered->next;
+    fwrite(ordered->data.constData(), 1, ordered->data.size(), stderr);
+    delete ordered;
+    ordered = next;
+  }
+  fflush(stderr);
+
+}
+
+static void WriterThread() {
+
+  while (!sWriterStopping.load()) {
+    {
+      std::unique_lock<std::mutex> l(sWriterMutex);
+      sWriterCondition.wait_for(l, std::chrono::milliseconds(100), []() { return sWriterStopping.load() || sPendingLines.load() != nullptr; });
+    }
+    FlushPendingLines();
+  }
+  FlushPendingLines();
+
+}
+
+static void StopWriterThread() {
+
+  if (!sWriterThread) return;
+
+  sWriterStopping = true;
+  sWriterCondition.notify_one();
+  sWriterThread->join();
+  delete sWriterThread;
+  sWriterThread = nullptr;
+
+}
+
+static void WriteLine(const QByteArray &data) {
+
+  if (!sWriterThread) {
+    fwrite(data.constData(), 1, data.size(), stderr);
+    return;
+  }
+
+  PendingLine *line = new PendingLine;
+  line->data = data;
+  line->next = sPendingLines.load(std::memory_order_relaxed);
+  while (!sPendingLines.compare_exchange_weak(line->next, line, std::memory_order_release, std::memory_order_relaxed)) {}
+
+  sWriterCondition.notify_one();
+
+}
+
 static void MessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message) {
 
-  if (strncmp(kMessageHandlerMagic, message.toLocal8Bit().data(), kMessageHandlerMagicLength) == 0) {
-    fprintf(stderr, "%s\n", message.toLocal8Bit().data() + kMessageHandlerMagicLength);
+  const QByteArray local_message = message.toLocal8Bit();
+  if (strncmp(kMessageHandlerMagic, local_message.constData(), kMessageHandlerMagicLength) == 0) {
+    WriteLine(local_message.mid(kMessageHandlerMagicLength) + '\n');
+    // Qt aborts after a fatal message, so make sure it and everything before it is written first.
+    if (type == QtFatalMsg) FlushPendingLines();
     return;
   }
 
@@ -94,21 +185,54 @@ static void MessageHandler(QtMsgType type, const QMessageLogContext &context, co
 
 void Init() {
 
-  delete sClassLevels;
-  delete sNullDevice;
+  {
+    std::lock_guard<std::mutex> l(sLevelsMutex);
+    delete sClassLevels;
+    delete sNullDevice;
 
-  sClassLevels = new QMap<QString, Level>();
-  sNullDevice = new NullDevice;
-  sNullDevice->open(QIODevice::ReadWrite);
+    sClassLevels = new QMap<QString, Level>();
+    sNullDevice = new NullDevice;
+    sNullDevice->open(QIODevice::ReadWrite);
+  }
+  ++sLevelsGeneration;
 
   // Catch other messages from Qt
   if (!sOriginalMessageHandler) {
     sOriginalMessageHandler = qInstallMessageHandler(MessageHandler);
   }
+
+  if (!sWriterThread) {
+    sWriterThread = new std::thread(WriterThread);
+    atexit(StopWriterThread);
+  }
+
+}
+
+static Level ThresholdLevel(const QString &class_name) {
+
+  std::lock_guard<std::mutex> l(sLevelsMutex);
+  if (sClassLevels && sClassLevels->contains(class_name)) {
+    return sClassLevels->value(class_name);
+  }
+  return sDefaultLevel;
+
+}
+
+bool CallSite::Refresh(Level level, const char *pretty_function) {
+
+  // Read the generation first, so a change made while looking up the threshold is picked up on the next call.
+  const int generation = sLevelsGeneration.load();
+  const Level threshold_level = ThresholdLevel(ParsePrettyFunction(pretty_function));
+  cached_.store((generation << 3) | (threshold_level + 1), std::memory_order_relaxed);
+
+  return level <= threshold_level;
+
 }
 
 void SetLevels(const QString &levels) {
 
+  std::lock_guard<std::mutex> l(sLevelsMutex);
+
   if (!sClassLevels) return;
 
   for (const QString& item : levels.split(',')) {
@@ -138,6 +262,8 @@ void SetLevels(const QString &levels) {
     }
   }
 
+  ++sLevelsGeneration;
+
 }
 
 QString ParsePrettyFunction(const char *pretty_function) {
@@ -176,12 +302,7 @@ QDebug CreateLogger(Level level, const QString &class_name, int line) {
   }
 
   // Check the settings to see if we're meant to show or hide this message.
-  Level threshold_level = sDefaultLevel;
-  if (sClassLevels && sClassLevels->contains(class_name)) {
-    threshold_level = sClassLevels->value(class_name);
-  }
-
-  if (level > threshold_level) {
+  if (level > ThresholdLevel(class_name)) {
     return QDebug(sNullDevice);
   }
 
@@ -250,6 +371,7 @@ QString DemangleSymbol(const QString &symbol) {
 
 void DumpStackTrace() {
 #ifdef Q_OS_UNIX
+  FlushPendingLines();
   void* callstack[128];
   int callstack_size = backtrace(reinterpret_cast<void**>(&callstack), sizeof(callstack));
   char** symbols = backtrace_symbols(reinterpret_cast<void**>(&callstack), callstack_size);
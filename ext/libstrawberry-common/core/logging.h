@@ -17,6 +17,7 @@
 #ifndef LOGGING_H
 #define LOGGING_H
 
+#include <atomic>
 #include <chrono>
 
 #include <QtGlobal>
@@ -27,7 +28,11 @@
 #ifdef QT_NO_DEBUG_STREAM
 #  define qLog(level) while (false) QNoDebug()
 #else
-#define qLog(level) logging::CreateLogger##level(__LINE__, __PRETTY_FUNCTION__)
+// The level is checked against a threshold cached at the call site before anything is built, so a disabled statement costs a
+// branch and its streamed arguments are never evaluated.
+#define qLog(level) \
+  for (bool qlog_enabled = [](const char *pretty_function) { static logging::CallSite site; return site.IsEnabled(logging::Level_##level, pretty_function); }(__PRETTY_FUNCTION__); qlog_enabled; qlog_enabled = false) \
+    logging::CreateLogger##level(__LINE__, __PRETTY_FUNCTION__)
 
 #define qCreateLogger(line, class_name, level) logging::CreateLogger(logging::Level_##level, logging::ParsePrettyFunction(class_name), line)
 #endif // QT_NO_DEBUG_STREAM
@@ -47,6 +52,28 @@ enum Level {
   Level_Debug,
 };
 
+// Bumped every time the levels change, invalidating the thresholds cached by each qLog call site.
+extern std::atomic<int> sLevelsGeneration;
+
+class CallSite {
+ public:
+  constexpr CallSite() : cached_(0) {}
+
+  bool IsEnabled(Level level, const char *pretty_function) {
+    // The low bits hold the threshold, the rest the generation it was looked up in.
+    const int cached = cached_.load(std::memory_order_relaxed);
+    if ((cached >> 3) != sLevelsGeneration.load(std::memory_order_relaxed)) {
+      return Refresh(level, pretty_function);
+    }
+    return level <= (cached & 7) - 1;
+  }
+
+ private:
+  bool Refresh(Level level, const char *pretty_function);
+
+  std::atomic<int> cached_;
+};
+
   void Init();
   void SetLevels(const QString& levels);
 
@@ -16,15 +16,41 @@
 
 #include "messagehandler.h"
 
+#ifdef Q_OS_LINUX
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <string.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/syscall.h>
+#  ifdef SYS_memfd_create
+#    define HAVE_SHARED_MEMORY_MESSAGES
+#    ifndef MFD_CLOEXEC
+#      define MFD_CLOEXEC 0x0001U
+#    endif
+#  endif
+#endif
+
 #include <QObject>
+#include <QCoreApplication>
 #include <QAbstractSocket>
 #include <QDataStream>
 #include <QIODevice>
 #include <QLocalSocket>
 #include <QByteArray>
+#include <QString>
 
 #include "core/logging.h"
 
+const int _MessageHandlerBase::kSharedMemoryThreshold = 262144;  // 256 KB
+
+// Lengths this large are never used for messages, so they mark the special frames.
+const quint32 _MessageHandlerBase::kSharedMemoryMessage = 0xFFFFFFFF;
+const quint32 _MessageHandlerBase::kSharedMemoryRelease = 0xFFFFFFFE;
+const int _MessageHandlerBase::kSharedMemoryMessageHeaderSize = 16;  // qint64 pid, qint32 fd, quint32 length
+const int _MessageHandlerBase::kSharedMemoryReleaseHeaderSize = 5;  // qint32 fd, bool fallback
+
 _MessageHandlerBase::_MessageHandlerBase(QIODevice *device, QObject *parent)
     : QObject(parent),
       device_(nullptr),
@@ -32,12 +58,17 @@ _MessageHandlerBase::_MessageHandlerBase(QIODevice *device, QObject *parent)
       flush_local_socket_(nullptr),
       reading_protobuf_(false),
       expected_length_(0),
-      is_device_closed_(false) {
+      is_device_closed_(false),
+      shared_memory_disabled_(false) {
   if (device) {
     SetDevice(device);
   }
 }
 
+_MessageHandlerBase::~_MessageHandlerBase() {
+  CloseSharedMemory();
+}
+
 void _MessageHandlerBase::SetDevice(QIODevice *device) {
 
   device_ = device;
@@ -72,6 +103,39 @@ void _MessageHandlerBase::DeviceReadyRead() {
       reading_protobuf_ = true;
     }
 
+    // A message in shared memory, only the header referencing it is on the socket.
+    if (expected_length_ == kSharedMemoryMessage) {
+      if (device_->bytesAvailable() < kSharedMemoryMessageHeaderSize) return;
+
+      QDataStream s(device_);
+      qint64 pid = 0;
+      qint32 fd = -1;
+      quint32 length = 0;
+      s >> pid >> fd >> length;
+      reading_protobuf_ = false;
+
+      if (!ReadSharedMemoryMessage(pid, fd, length)) {
+        qLog(Error) << "Malformed protobuf message";
+        device_->close();
+        return;
+      }
+      continue;
+    }
+
+    // The receiver is done with one of our shared memory messages.
+    if (expected_length_ == kSharedMemoryRelease) {
+      if (device_->bytesAvailable() < kSharedMemoryReleaseHeaderSize) return;
+
+      QDataStream s(device_);
+      qint32 fd = -1;
+      bool fallback = false;
+      s >> fd >> fallback;
+      reading_protobuf_ = false;
+
+      SharedMemoryReleased(fd, fallback);
+      continue;
+    }
+
     // Read some of the message
     buffer_.write(device_->read(expected_length_ - buffer_.size()));
 
@@ -96,10 +160,18 @@ void _MessageHandlerBase::DeviceReadyRead() {
 
 void _MessageHandlerBase::WriteMessage(const QByteArray &data) {
 
+  // Large messages like embedded art would otherwise be copied through the socket buffers on both sides.
+  if (data.length() >= kSharedMemoryThreshold && !shared_memory_disabled_ && WriteSharedMemoryMessage(data)) return;
+
   QDataStream s(device_);
   s << quint32(data.length());
   s.writeRawData(data.data(), data.length());
 
+  Flush();
+}
+
+void _MessageHandlerBase::Flush() {
+
   // Sorry.
   if (flush_abstract_socket_) {
     ((static_cast<QAbstractSocket*>(device_))->*(flush_abstract_socket_))();
@@ -109,8 +181,143 @@ void _MessageHandlerBase::WriteMessage(const QByteArray &data) {
   }
 }
 
+bool _MessageHandlerBase::WriteSharedMemoryMessage(const QByteArray &data) {
+
+#ifdef HAVE_SHARED_MEMORY_MESSAGES
+  const qint32 fd = syscall(SYS_memfd_create, "strawberry-message", MFD_CLOEXEC);
+  if (fd == -1) {
+    qLog(Warning) << "Could not create shared memory for message:" << strerror(errno);
+    shared_memory_disabled_ = true;
+    return false;
+  }
+
+  qint64 written = 0;
+  while (written < data.length()) {
+    const ssize_t ret = write(fd, data.constData() + written, data.length() - written);
+    if (ret == -1) {
+      if (errno == EINTR) continue;
+      qLog(Warning) << "Could not write message to shared memory:" << strerror(errno);
+      close(fd);
+      return false;
+    }
+    written += ret;
+  }
+  shared_memory_fds_ << fd;
+
+  // The receiver opens the memfd through /proc, it's closed here when the receiver releases it.
+  QDataStream s(device_);
+  s << kSharedMemoryMessage << qint64(QCoreApplication::applicationPid()) << fd << quint32(data.length());
+
+  Flush();
+
+  return true;
+#else
+  Q_UNUSED(data);
+  return false;
+#endif
+
+}
+
+bool _MessageHandlerBase::ReadSharedMemoryMessage(const qint64 pid, const qint32 fd, const quint32 length) {
+
+#ifdef HAVE_SHARED_MEMORY_MESSAGES
+  const QByteArray path = QString("/proc/%1/fd/%2").arg(pid).arg(fd).toLocal8Bit();
+  const int local_fd = open(path.constData(), O_RDONLY | O_CLOEXEC);
+  if (local_fd == -1) {
+    qLog(Warning) << "Could not open shared memory message" << path << strerror(errno);
+    WriteSharedMemoryRelease(fd, true);
+    return true;
+  }
+
+  // Accessing a mapping beyond the end of the file raises SIGBUS, so make sure it holds the whole message.
+  struct stat info;
+  if (fstat(local_fd, &info) == -1 || info.st_size < static_cast<off_t>(length)) {
+    qLog(Warning) << "Shared memory message" << path << "is smaller than the expected" << length << "bytes";
+    close(local_fd);
+    WriteSharedMemoryRelease(fd, true);
+    return true;
+  }
+
+  void *map = mmap(nullptr, length, PROT_READ, MAP_SHARED, local_fd, 0);
+  close(local_fd);
+  if (map == MAP_FAILED) {
+    qLog(Warning) << "Could not map shared memory message" << path << strerror(errno);
+    WriteSharedMemoryRelease(fd, true);
+    return true;
+  }
+
+  // The mapping keeps the memory alive, so the sender can close its memfd straight away.
+  WriteSharedMemoryRelease(fd, false);
+
+  const bool success = RawMessageArrived(QByteArray::fromRawData(static_cast<const char*>(map), length));
+  munmap(map, length);
+
+  return success;
+#else
+  Q_UNUSED(pid);
+  Q_UNUSED(length);
+  WriteSharedMemoryRelease(fd, true);
+  return true;
+#endif
+
+}
+
+void _MessageHandlerBase::WriteSharedMemoryRelease(const qint32 fd, const bool fallback) {
+
+  QDataStream s(device_);
+  s << kSharedMemoryRelease << fd << fallback;
+
+  Flush();
+
+}
+
+void _MessageHandlerBase::SharedMemoryReleased(const qint32 fd, const bool fallback) {
+
+#ifdef HAVE_SHARED_MEMORY_MESSAGES
+  if (!shared_memory_fds_.remove(fd)) return;
+
+  if (fallback) {
+    // The receiver can't open our shared memory, send this message over the socket instead and don't try again.
+    shared_memory_disabled_ = true;
+
+    QByteArray data;
+    struct stat info;
+    if (fstat(fd, &info) == 0) {
+      data.resize(info.st_size);
+      if (pread(fd, data.data(), data.size(), 0) != data.size()) data.clear();
+    }
+    close(fd);
+
+    if (data.isEmpty()) {
+      qLog(Error) << "Could not read back shared memory message";
+      return;
+    }
+    WriteMessage(data);
+    return;
+  }
+
+  close(fd);
+#else
+  Q_UNUSED(fd);
+  Q_UNUSED(fallback);
+#endif
+
+}
+
+void _MessageHandlerBase::CloseSharedMemory() {
+
+#ifdef HAVE_SHARED_MEMORY_MESSAGES
+  for (const qint32 fd : shared_memory_fds_) {
+    close(fd);
+  }
+#endif
+  shared_memory_fds_.clear();
+
+}
+
 void _MessageHandlerBase::DeviceClosed() {
   is_device_closed_ = true;
+  CloseSharedMemory();
   AbortAll();
 }
 
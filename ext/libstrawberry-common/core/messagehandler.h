@@ -27,6 +27,7 @@
 #include <QBuffer>
 #include <QByteArray>
 #include <QMap>
+#include <QSet>
 #include <QString>
 #include <QLocalSocket>
 #include <QAbstractSocket>
@@ -37,6 +38,7 @@
 #define DataCommaSizeFromQString(x) x.toUtf8().constData(), x.toUtf8().length()
 
 // Reads and writes uint32 length encoded protobufs to a socket.
+// On Linux, messages larger than kSharedMemoryThreshold are written to a memfd instead, and only a small header referencing it is sent on the socket.
 // This base QObject is separate from AbstractMessageHandler because moc can't handle templated classes.
 // Use AbstractMessageHandler instead.
 class _MessageHandlerBase : public QObject {
@@ -45,6 +47,9 @@ class _MessageHandlerBase : public QObject {
 public:
   // device can be nullptr, in which case you must call SetDevice before writing any messages.
   _MessageHandlerBase(QIODevice *device, QObject *parent);
+  ~_MessageHandlerBase();
+
+  static const int kSharedMemoryThreshold;
 
   void SetDevice(QIODevice *device);
 
@@ -60,6 +65,19 @@ protected:
   virtual bool RawMessageArrived(const QByteArray &data) = 0;
   virtual void AbortAll() = 0;
 
+private:
+  static const quint32 kSharedMemoryMessage;
+  static const quint32 kSharedMemoryRelease;
+  static const int kSharedMemoryMessageHeaderSize;
+  static const int kSharedMemoryReleaseHeaderSize;
+
+  void Flush();
+  bool WriteSharedMemoryMessage(const QByteArray &data);
+  bool ReadSharedMemoryMessage(const qint64 pid, const qint32 fd, const quint32 length);
+  void WriteSharedMemoryRelease(const qint32 fd, const bool fallback);
+  void SharedMemoryReleased(const qint32 fd, const bool fallback);
+  void CloseSharedMemory();
+
 protected:
   typedef bool (QAbstractSocket::*FlushAbstractSocket)();
   typedef bool (QLocalSocket::*FlushLocalSocket)();
@@ -73,6 +91,11 @@ protected:
   QBuffer buffer_;
 
   bool is_device_closed_;
+
+  // memfds of messages sent in shared memory, kept open until the receiver has opened its own reference.
+  QSet<qint32> shared_memory_fds_;
+  // Set when the receiver could not open our shared memory, large messages are sent over the socket after that.
+  bool shared_memory_disabled_;
 };
 
 // Reads and writes uint32 length encoded MessageType messages to a socket.
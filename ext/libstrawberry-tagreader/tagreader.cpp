@@ -84,8 +84,17 @@
 #include <QTextCodec>
 #include <QVector>
 #include <QNetworkAccessManager>
+#include <QBuffer>
+#include <QImage>
+#include <QImageReader>
+#include <QSize>
 #include <QtDebug>
 
+#ifdef Q_OS_UNIX
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
 #include "core/logging.h"
 #include "core/messagehandler.h"
 
@@ -159,7 +168,7 @@ pb::tagreader::SongMetadata_FileType TagReader::GuessFileType(TagLib::FileRef *f
 
 }
 
-void TagReader::ReadFile(const QString &filename, pb::tagreader::SongMetadata *song) const {
+void TagReader::ReadFile(const QString &filename, pb::tagreader::SongMetadata *song, const int thumbnail_size, QByteArray *thumbnail) const {
 
   const QByteArray url(QUrl::fromLocalFile(filename).toEncoded());
   const QFileInfo info(filename);
@@ -180,6 +189,10 @@ void TagReader::ReadFile(const QString &filename, pb::tagreader::SongMetadata *s
 
   song->set_filetype(GuessFileType(fileref.get()));
 
+  if (thumbnail && thumbnail_size > 0) {
+    *thumbnail = ScaleThumbnail(LoadEmbeddedArt(fileref.get()), thumbnail_size);
+  }
+
   if (fileref->audioProperties()) {
     song->set_bitrate(fileref->audioProperties()->bitrate());
     song->set_samplerate(fileref->audioProperties()->sampleRate());
@@ -622,6 +635,22 @@ bool TagReader::SaveFile(const QString &filename, const pb::tagreader::SongMetad
   return ret;
 }
 
+void TagReader::SyncFiles(const QStringList &filenames) const {
+
+#ifdef Q_OS_UNIX
+  // Only the saved files are flushed, syncing the whole filesystem would also wait for unrelated writes.
+  for (const QString &filename : filenames) {
+    int fd = open(QFile::encodeName(filename).constData(), O_RDONLY);
+    if (fd == -1) continue;
+    fsync(fd);
+    close(fd);
+  }
+#else
+  Q_UNUSED(filenames);
+#endif
+
+}
+
 void TagReader::SaveAPETag(TagLib::APE::Tag *tag, const pb::tagreader::SongMetadata &song) const {
 
   tag->setItem("album artist", TagLib::APE::Item("album artist", TagLib::StringList(song.albumartist().c_str())));
@@ -717,7 +746,15 @@ QByteArray TagReader::LoadEmbeddedArt(const QString &filename) const {
   TagLib::FileRef ref(QFile::encodeName(filename).constData());
 #endif
 
-  if (ref.isNull() || !ref.file()) return QByteArray();
+  return LoadEmbeddedArt(&ref);
+
+}
+
+QByteArray TagReader::LoadEmbeddedArt(TagLib::FileRef *fileref) const {
+
+  if (fileref->isNull() || !fileref->file()) return QByteArray();
+
+  TagLib::FileRef &ref = *fileref;
 
   // FLAC
   TagLib::FLAC::File *flac_file = dynamic_cast<TagLib::FLAC::File*>(ref.file());
@@ -813,6 +850,38 @@ QByteArray TagReader::LoadEmbeddedArt(const QString &filename) const {
 
 }
 
+QByteArray TagReader::ScaleThumbnail(const QByteArray &data, const int size) {
+
+  if (data.isEmpty()) return QByteArray();
+
+  QImageReader reader;
+  QBuffer buffer;
+  buffer.setData(data);
+  buffer.open(QIODevice::ReadOnly);
+  reader.setDevice(&buffer);
+
+  // Let the image plugin decode straight to the thumbnail size.
+  QSize image_size = reader.size();
+  if (image_size.isValid() && (image_size.width() > size || image_size.height() > size)) {
+    image_size.scale(size, size, Qt::KeepAspectRatio);
+    reader.setScaledSize(image_size);
+  }
+
+  QImage image = reader.read();
+  if (image.isNull()) return QByteArray();
+  if (image.width() > size || image.height() > size) {
+    image = image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+  }
+
+  QByteArray thumbnail;
+  QBuffer thumbnail_buffer(&thumbnail);
+  thumbnail_buffer.open(QIODevice::WriteOnly);
+  if (!image.save(&thumbnail_buffer, "JPG", 90)) return QByteArray();
+
+  return thumbnail;
+
+}
+
 QByteArray TagReader::LoadEmbeddedAPEArt(const TagLib::APE::ItemListMap &map) const {
 
   QByteArray ret;
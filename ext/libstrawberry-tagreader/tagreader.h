@@ -25,6 +25,7 @@
 
 #include <QByteArray>
 #include <QString>
+#include <QStringList>
 #include <QNetworkAccessManager>
 #include <QTextCodec>
 
@@ -56,11 +57,16 @@ class TagReader {
 
   pb::tagreader::SongMetadata_FileType GuessFileType(TagLib::FileRef *fileref) const;
 
-  void ReadFile(const QString &filename, pb::tagreader::SongMetadata *song) const;
+  // If thumbnail is given, the embedded cover is read from the same file and scaled down to thumbnail_size.
+  void ReadFile(const QString &filename, pb::tagreader::SongMetadata *song, const int thumbnail_size = 0, QByteArray *thumbnail = nullptr) const;
   bool SaveFile(const QString &filename, const pb::tagreader::SongMetadata &song) const;
+  // Flushes the given files to disk with one fsync each, used after saving a batch of files.
+  void SyncFiles(const QStringList &filenames) const;
 
   bool IsMediaFile(const QString &filename) const;
   QByteArray LoadEmbeddedArt(const QString &filename) const;
+  QByteArray LoadEmbeddedArt(TagLib::FileRef *fileref) const;
+  static QByteArray ScaleThumbnail(const QByteArray &data, const int size);
   QByteArray LoadEmbeddedAPEArt(const TagLib::APE::ItemListMap &map) const;
 
   static void Decode(const TagLib::String& tag, const QTextCodec *codec, std::string *output);
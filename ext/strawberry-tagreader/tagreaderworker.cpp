@@ -23,6 +23,8 @@
 #include <QObject>
 #include <QIODevice>
 #include <QByteArray>
+#include <QString>
+#include <QStringList>
 
 #include "tagreaderworker.h"
 
@@ -44,11 +46,30 @@ void TagReaderWorker::MessageArrived(const pb::tagreader::Message& message) {
 #endif
 
   if (message.has_read_file_request()) {
-    tag_reader_.ReadFile(QStringFromStdString(message.read_file_request().filename()), reply.mutable_read_file_response()->mutable_metadata());
+    const pb::tagreader::ReadFileRequest &request = message.read_file_request();
+    if (request.thumbnail_size() > 0) {
+      QByteArray thumbnail;
+      tag_reader_.ReadFile(QStringFromStdString(request.filename()), reply.mutable_read_file_response()->mutable_metadata(), request.thumbnail_size(), &thumbnail);
+      if (!thumbnail.isEmpty()) reply.mutable_read_file_response()->set_thumbnail(thumbnail.constData(), thumbnail.size());
+    }
+    else {
+      tag_reader_.ReadFile(QStringFromStdString(request.filename()), reply.mutable_read_file_response()->mutable_metadata());
+    }
   }
   else if (message.has_save_file_request()) {
     reply.mutable_save_file_response()->set_success(tag_reader_.SaveFile(QStringFromStdString(message.save_file_request().filename()), message.save_file_request().metadata()));
   }
+  else if (message.has_save_files_request()) {
+    // Save all files first, then flush them to disk once for the whole batch.
+    QStringList saved_files;
+    for (const pb::tagreader::SaveFileRequest &request : message.save_files_request().files()) {
+      const QString filename = QStringFromStdString(request.filename());
+      const bool success = tag_reader_.SaveFile(filename, request.metadata());
+      reply.mutable_save_files_response()->add_success(success);
+      if (success) saved_files << filename;
+    }
+    tag_reader_.SyncFiles(saved_files);
+  }
 
   else if (message.has_is_media_file_request()) {
     reply.mutable_is_media_file_response()->set_success(tag_reader_.IsMediaFile(QStringFromStdString(message.is_media_file_request().filename())));
@@ -33,6 +33,7 @@
 #include "core/thread.h"
 #include "core/utilities.h"
 #include "core/song.h"
+#include "covermanager/albumcoverloader.h"
 #include "collection.h"
 #include "collectionwatcher.h"
 #include "collectionbackend.h"
@@ -43,6 +44,11 @@ const char *SCollection::kSongsTable = "songs";
 const char *SCollection::kDirsTable = "directories";
 const char *SCollection::kSubdirsTable = "subdirectories";
 const char *SCollection::kFtsTable = "songs_fts";
+const char *SCollection::kAlbumsTable = "albums";
+const char *SCollection::kArtThumbnailsTable = "art_thumbnails";
+const char *SCollection::kSongsArtThumbnailsTable = "songs_art_thumbnails";
+const char *SCollection::kFingerprintsTable = "fingerprints";
+const char *SCollection::kChangedAlbumsTable = "changed_albums";
 
 SCollection::SCollection(Application *app, QObject *parent)
     : QObject(parent),
@@ -50,24 +56,38 @@ SCollection::SCollection(Application *app, QObject *parent)
       backend_(nullptr),
       model_(nullptr),
       watcher_(nullptr),
-      watcher_thread_(nullptr) {
+      watcher_thread_(nullptr),
+      pending_incremental_scan_(false),
+      pending_full_scan_(false),
+      watcher_paused_(false) {
 
   backend_ = new CollectionBackend();
   backend()->moveToThread(app->database()->thread());
 
-  backend_->Init(app->database(), kSongsTable, kDirsTable, kSubdirsTable, kFtsTable);
+  backend_->Init(app->database(), kSongsTable, kDirsTable, kSubdirsTable, kFtsTable, kAlbumsTable, kArtThumbnailsTable, kSongsArtThumbnailsTable, kFingerprintsTable, kChangedAlbumsTable);
 
   model_ = new CollectionModel(backend_, app_, this);
 
+  // Files scanned before schema 7 have no embedded art thumbnails stored yet.
+  full_rescan_revisions_[7] = tr("Faster loading of embedded album covers");
+
+  connect(app_->playlist_manager(), SIGNAL(CurrentSongChanged(Song)), SLOT(CurrentSongChanged(Song)));
+  connect(app_->player(), SIGNAL(Stopped()), SLOT(Stopped()));
+
   ReloadSettings();
 
 }
 
 SCollection::~SCollection() {
+
+  // The watcher is only created by Init(), which is deferred until after startup.
+  if (!watcher_) return;
+
   watcher_->Stop();
   watcher_->deleteLater();
   watcher_thread_->exit();
   watcher_thread_->wait(5000 /* five seconds */);
+
 }
 
 void SCollection::Init() {
@@ -81,6 +101,7 @@ void SCollection::Init() {
 
   watcher_->set_backend(backend_);
   watcher_->set_task_manager(app_->task_manager());
+  if (watcher_paused_) watcher_->SetRescanPausedAsync(true);
 
   connect(backend_, SIGNAL(DirectoryDiscovered(Directory, SubdirectoryList)), watcher_, SLOT(AddDirectory(Directory, SubdirectoryList)));
   connect(backend_, SIGNAL(DirectoryDeleted(Directory)), watcher_, SLOT(RemoveDirectory(Directory)));
@@ -90,25 +111,68 @@ void SCollection::Init() {
   connect(watcher_, SIGNAL(SongsReadded(SongList, bool)), backend_, SLOT(MarkSongsUnavailable(SongList, bool)));
   connect(watcher_, SIGNAL(SubdirsDiscovered(SubdirectoryList)), backend_, SLOT(AddOrUpdateSubdirs(SubdirectoryList)));
   connect(watcher_, SIGNAL(SubdirsMTimeUpdated(SubdirectoryList)), backend_, SLOT(AddOrUpdateSubdirs(SubdirectoryList)));
+  connect(watcher_, SIGNAL(ArtThumbnailsUpdated(QMap<QString, QByteArray>)), backend_, SLOT(UpdateArtThumbnails(QMap<QString, QByteArray>)));
   connect(watcher_, SIGNAL(CompilationsNeedUpdating()), backend_, SLOT(UpdateCompilations()));
-  connect(app_->playlist_manager(), SIGNAL(CurrentSongChanged(Song)), SLOT(CurrentSongChanged(Song)));
-  connect(app_->player(), SIGNAL(Stopped()), SLOT(Stopped()));
+
+  backend_->UpdateDuplicateKeysAsync();
+  backend_->DeleteUnusedArtThumbnailsAsync();
+
+  // Embedded covers of collection songs can be loaded from the thumbnails stored during the scan.
+  app_->album_cover_loader()->SetCollectionBackend(backend_);
+
+  // Scans requested before this have to wait until the watcher knows the directories.
+  if (pending_incremental_scan_ || pending_full_scan_) {
+    connect(backend_, SIGNAL(DirectoriesLoaded()), SLOT(DirectoriesLoaded()));
+  }
 
   // This will start the watcher checking for updates
   backend_->LoadDirectoriesAsync();
 }
 
-void SCollection::IncrementalScan() { watcher_->IncrementalScanAsync(); }
+void SCollection::DirectoriesLoaded() {
+
+  disconnect(backend_, SIGNAL(DirectoriesLoaded()), this, SLOT(DirectoriesLoaded()));
 
-void SCollection::FullScan() { watcher_->FullScanAsync(); }
+  // A full scan includes everything an incremental scan does.
+  if (pending_full_scan_) watcher_->FullScanAsync();
+  else if (pending_incremental_scan_) watcher_->IncrementalScanAsync();
 
-void SCollection::PauseWatcher() { watcher_->SetRescanPausedAsync(true); }
+  pending_incremental_scan_ = false;
+  pending_full_scan_ = false;
+
+}
 
-void SCollection::ResumeWatcher() { watcher_->SetRescanPausedAsync(false); }
+void SCollection::IncrementalScan() {
+
+  if (watcher_) watcher_->IncrementalScanAsync();
+  else pending_incremental_scan_ = true;
+
+}
+
+void SCollection::FullScan() {
+
+  if (watcher_) watcher_->FullScanAsync();
+  else pending_full_scan_ = true;
+
+}
+
+void SCollection::PauseWatcher() {
+
+  watcher_paused_ = true;
+  if (watcher_) watcher_->SetRescanPausedAsync(true);
+
+}
+
+void SCollection::ResumeWatcher() {
+
+  watcher_paused_ = false;
+  if (watcher_) watcher_->SetRescanPausedAsync(false);
+
+}
 
 void SCollection::ReloadSettings() {
 
-  watcher_->ReloadSettingsAsync();
+  if (watcher_) watcher_->ReloadSettingsAsync();
 
 }
 
@@ -47,6 +47,11 @@ class SCollection : public QObject {
   static const char *kDirsTable;
   static const char *kSubdirsTable;
   static const char *kFtsTable;
+  static const char *kAlbumsTable;
+  static const char *kArtThumbnailsTable;
+  static const char *kSongsArtThumbnailsTable;
+  static const char *kFingerprintsTable;
+  static const char *kChangedAlbumsTable;
 
   void Init();
 
@@ -72,6 +77,7 @@ class SCollection : public QObject {
 
   void CurrentSongChanged(const Song &song);
   void Stopped();
+  void DirectoriesLoaded();
 
  private:
   Application *app_;
@@ -81,6 +87,11 @@ class SCollection : public QObject {
   CollectionWatcher *watcher_;
   Thread *watcher_thread_;
 
+  // Requests made before the deferred Init() created the watcher, they're replayed once the watcher has its directories.
+  bool pending_incremental_scan_;
+  bool pending_full_scan_;
+  bool watcher_paused_;
+
   // DB schema versions which should trigger a full collection rescan (each of those with a short reason why).
   QHash<int, QString> full_rescan_revisions_;
 };
@@ -25,7 +25,10 @@
 #include <QMutex>
 #include <QSet>
 #include <QMap>
+#include <QHash>
+#include <QPair>
 #include <QByteArray>
+#include <QCryptographicHash>
 #include <QFileInfo>
 #include <QDateTime>
 #include <QVariant>
@@ -48,17 +51,28 @@
 #include "sqlrow.h"
 
 const char *CollectionBackend::kSettingsGroup = "Collection";
+const int CollectionBackend::kArtThumbnailSize = 128;
 
 CollectionBackend::CollectionBackend(QObject *parent) :
     CollectionBackendInterface(parent),
-    db_(nullptr) {}
+    db_(nullptr),
+    changed_albums_unknown_(false),
+    song_counts_loaded_(false),
+    song_count_(0) {}
 
-void CollectionBackend::Init(Database *db, const QString &songs_table, const QString &dirs_table, const QString &subdirs_table, const QString &fts_table) {
+void CollectionBackend::Init(Database *db, const QString &songs_table, const QString &dirs_table, const QString &subdirs_table, const QString &fts_table, const QString &albums_table, const QString &art_thumbnails_table, const QString &songs_art_thumbnails_table, const QString &fingerprints_table, const QString &changed_albums_table) {
   db_ = db;
   songs_table_ = songs_table;
   dirs_table_ = dirs_table;
   subdirs_table_ = subdirs_table;
   fts_table_ = fts_table;
+  albums_table_ = albums_table;
+  art_thumbnails_table_ = art_thumbnails_table;
+  songs_art_thumbnails_table_ = songs_art_thumbnails_table;
+  fingerprints_table_ = fingerprints_table;
+  changed_albums_table_ = changed_albums_table;
+  // Without a table the changed albums are only kept in memory, so what changed before is unknown.
+  changed_albums_unknown_ = changed_albums_table_.isEmpty();
 }
 
 void CollectionBackend::LoadDirectoriesAsync() {
@@ -77,6 +91,14 @@ void CollectionBackend::UpdateTotalAlbumCountAsync() {
   metaObject()->invokeMethod(this, "UpdateTotalAlbumCount", Qt::QueuedConnection);
 }
 
+void CollectionBackend::UpdateDuplicateKeysAsync() {
+  metaObject()->invokeMethod(this, "UpdateDuplicateKeys", Qt::QueuedConnection);
+}
+
+void CollectionBackend::DeleteUnusedArtThumbnailsAsync() {
+  metaObject()->invokeMethod(this, "DeleteUnusedArtThumbnails", Qt::QueuedConnection);
+}
+
 void CollectionBackend::IncrementPlayCountAsync(int id) {
   metaObject()->invokeMethod(this, "IncrementPlayCount", Qt::QueuedConnection, Q_ARG(int, id));
 }
@@ -100,6 +122,8 @@ void CollectionBackend::LoadDirectories() {
     emit DirectoryDiscovered(dir, SubdirsInDirectory(dir.id, db));
   }
 
+  emit DirectoriesLoaded();
+
 }
 
 void CollectionBackend::ChangeDirPath(int id, const QString &old_path, const QString &new_path) {
@@ -143,6 +167,21 @@ void CollectionBackend::ChangeDirPath(int id, const QString &old_path, const QSt
     if (db_->CheckErrors(q)) return;
   }
 
+  // The albums keep the filename of their first song
+  if (!albums_table_.isEmpty()) {
+    QSqlQuery q(db);
+    q.prepare(QString("SELECT DISTINCT album FROM %1 WHERE directory_id = :id").arg(songs_table_));
+    q.bindValue(":id", id);
+    q.exec();
+    if (db_->CheckErrors(q)) return;
+
+    QSet<QString> albums;
+    while (q.next()) {
+      albums << q.value(0).toString();
+    }
+    UpdateAlbums(db, albums);
+  }
+
   t.Commit();
 
 }
@@ -199,48 +238,287 @@ SubdirectoryList CollectionBackend::SubdirsInDirectory(int id, QSqlDatabase &db)
 
 }
 
-void CollectionBackend::UpdateTotalSongCount() {
+bool CollectionBackend::LoadSongCounts() {
 
   QMutexLocker l(db_->Mutex());
+
+  if (song_counts_loaded_) return true;
+
   QSqlDatabase db(db_->Connect());
 
+  // This is the only time the whole table is counted, after this the counts are adjusted as songs are written.
   QSqlQuery q(db);
-  q.prepare(QString("SELECT COUNT(*) FROM %1 WHERE unavailable = 0").arg(songs_table_));
+  q.prepare(QString("SELECT artist, album, COUNT(*) FROM %1 WHERE unavailable = 0 GROUP BY artist, album").arg(songs_table_));
   q.exec();
-  if (db_->CheckErrors(q)) return;
-  if (!q.next()) return;
+  if (db_->CheckErrors(q)) return false;
+
+  song_count_ = 0;
+  artist_song_counts_.clear();
+  album_song_counts_.clear();
+  while (q.next()) {
+    const int songs = q.value(2).toInt();
+    song_count_ += songs;
+    artist_song_counts_[q.value(0).toString()] += songs;
+    album_song_counts_[q.value(1).toString()] += songs;
+  }
+  song_counts_loaded_ = true;
+
+  return true;
+
+}
+
+void CollectionBackend::AdjustSongCounts(const QList<SongCountChange> &changes) {
+
+  // Until the counts are loaded they will include the changes anyway.
+  if (!song_counts_loaded_) return;
+
+  for (const SongCountChange &change : changes) {
+    song_count_ += change.songs;
+
+    int &artist_songs = artist_song_counts_[change.artist];
+    artist_songs += change.songs;
+    if (artist_songs <= 0) artist_song_counts_.remove(change.artist);
+
+    int &album_songs = album_song_counts_[change.album];
+    album_songs += change.songs;
+    if (album_songs <= 0) album_song_counts_.remove(change.album);
+  }
+
+}
+
+int CollectionBackend::ArtistSongCount(const QString &artist) {
+
+  QMutexLocker l(db_->Mutex());
+  if (!LoadSongCounts()) return 0;
+  return artist_song_counts_.value(artist);
+
+}
 
-  emit TotalSongCountUpdated(q.value(0).toInt());
+int CollectionBackend::AlbumSongCount(const QString &album) {
+
+  QMutexLocker l(db_->Mutex());
+  if (!LoadSongCounts()) return 0;
+  return album_song_counts_.value(album);
+
+}
+
+void CollectionBackend::UpdateTotalSongCount() {
+
+  QMutexLocker l(db_->Mutex());
+  if (!LoadSongCounts()) return;
+
+  emit TotalSongCountUpdated(song_count_);
 
 }
 
 void CollectionBackend::UpdateTotalArtistCount() {
 
+  QMutexLocker l(db_->Mutex());
+  if (!LoadSongCounts()) return;
+
+  emit TotalArtistCountUpdated(artist_song_counts_.count());
+
+}
+
+void CollectionBackend::UpdateTotalAlbumCount() {
+
+  QMutexLocker l(db_->Mutex());
+  if (!LoadSongCounts()) return;
+
+  emit TotalAlbumCountUpdated(album_song_counts_.count());
+
+}
+
+void CollectionBackend::UpdateDuplicateKeys() {
+
   QMutexLocker l(db_->Mutex());
   QSqlDatabase db(db_->Connect());
 
+  // Songs written before the duplicate key existed don't have one yet, the key can't be calculated in SQL so it's filled in here.
   QSqlQuery q(db);
-  q.prepare(QString("select COUNT(distinct artist) from %1 WHERE unavailable = 0").arg(songs_table_));
+  q.setForwardOnly(true);
+  q.prepare(QString("SELECT ROWID, artist, album, title FROM %1 WHERE duplicate_key IS NULL AND artist != '' AND album != '' AND title != ''").arg(songs_table_));
   q.exec();
   if (db_->CheckErrors(q)) return;
-  if (!q.next()) return;
 
-  emit TotalArtistCountUpdated(q.value(0).toInt());
+  QList<QPair<int, QVariant>> keys;
+  while (q.next()) {
+    const QVariant key = Song::DuplicateKey(q.value(1).toString(), q.value(2).toString(), q.value(3).toString());
+    if (!key.isNull()) keys << qMakePair(q.value(0).toInt(), key);
+  }
+  if (keys.isEmpty()) return;
+
+  qLog(Debug) << "Adding duplicate keys to" << keys.count() << "songs in" << songs_table_;
+
+  QSqlQuery update(db);
+  update.prepare(QString("UPDATE %1 SET duplicate_key = :duplicate_key WHERE ROWID = :id").arg(songs_table_));
+
+  ScopedTransaction transaction(&db);
+  for (const QPair<int, QVariant> &key : keys) {
+    update.bindValue(":duplicate_key", key.second);
+    update.bindValue(":id", key.first);
+    update.exec();
+    if (db_->CheckErrors(update)) return;
+  }
+  transaction.Commit();
 
 }
 
-void CollectionBackend::UpdateTotalAlbumCount() {
+void CollectionBackend::UpdateArtThumbnails(const QMap<QString, QByteArray> &thumbnails) {
+
+  if (art_thumbnails_table_.isEmpty() || songs_art_thumbnails_table_.isEmpty()) return;
 
   QMutexLocker l(db_->Mutex());
   QSqlDatabase db(db_->Connect());
 
+  QSqlQuery add_thumbnail(db);
+  add_thumbnail.prepare(QString("INSERT OR IGNORE INTO %1 (hash, thumbnail) VALUES (:hash, :thumbnail)").arg(art_thumbnails_table_));
+  QSqlQuery add_song(db);
+  add_song.prepare(QString("INSERT OR REPLACE INTO %1 (filename, hash) VALUES (:filename, :hash)").arg(songs_art_thumbnails_table_));
+  QSqlQuery remove_song(db);
+  remove_song.prepare(QString("DELETE FROM %1 WHERE filename = :filename").arg(songs_art_thumbnails_table_));
+
+  ScopedTransaction transaction(&db);
+  for (QMap<QString, QByteArray>::const_iterator it = thumbnails.constBegin(); it != thumbnails.constEnd(); ++it) {
+    if (it.value().isEmpty()) {
+      remove_song.bindValue(":filename", it.key());
+      remove_song.exec();
+      if (db_->CheckErrors(remove_song)) return;
+      continue;
+    }
+
+    // Albums usually have the same art embedded in every track, so each distinct thumbnail is only stored once.
+    const QByteArray md5 = QCryptographicHash::hash(it.value(), QCryptographicHash::Md5);
+    qint64 hash = 0;
+    for (int i = 0; i < 8; ++i) hash = (hash << 8) | quint8(md5[i]);
+
+    add_thumbnail.bindValue(":hash", hash);
+    add_thumbnail.bindValue(":thumbnail", it.value());
+    add_thumbnail.exec();
+    if (db_->CheckErrors(add_thumbnail)) return;
+
+    add_song.bindValue(":filename", it.key());
+    add_song.bindValue(":hash", hash);
+    add_song.exec();
+    if (db_->CheckErrors(add_song)) return;
+  }
+  transaction.Commit();
+
+}
+
+void CollectionBackend::DeleteUnusedArtThumbnails() {
+
+  if (art_thumbnails_table_.isEmpty() || songs_art_thumbnails_table_.isEmpty()) return;
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+  ScopedTransaction transaction(&db);
+
   QSqlQuery q(db);
-  q.prepare(QString("select COUNT(distinct album) from %1 WHERE unavailable = 0").arg(songs_table_));
+  q.prepare(QString("DELETE FROM %1 WHERE filename NOT IN (SELECT filename FROM %2)").arg(songs_art_thumbnails_table_, songs_table_));
+  q.exec();
+  if (db_->CheckErrors(q)) return;
+
+  q = QSqlQuery(db);
+  q.prepare(QString("DELETE FROM %1 WHERE hash NOT IN (SELECT hash FROM %2)").arg(art_thumbnails_table_, songs_art_thumbnails_table_));
   q.exec();
   if (db_->CheckErrors(q)) return;
-  if (!q.next()) return;
 
-  emit TotalAlbumCountUpdated(q.value(0).toInt());
+  transaction.Commit();
+
+}
+
+void CollectionBackend::AddChangedAlbums(QSqlDatabase &db, const QSet<QString> &albums) {
+
+  if (changed_albums_table_.isEmpty()) {
+    changed_albums_.unite(albums);
+    return;
+  }
+
+  QSqlQuery q(db);
+  q.prepare(QString("INSERT OR IGNORE INTO %1 (album) VALUES (:album)").arg(changed_albums_table_));
+  for (const QString &album : albums) {
+    if (album.isEmpty()) continue;
+    q.bindValue(":album", album);
+    q.exec();
+    if (db_->CheckErrors(q)) return;
+  }
+
+}
+
+QSet<QString> CollectionBackend::TakeChangedAlbums(QSqlDatabase &db) {
+
+  QSet<QString> albums;
+
+  if (changed_albums_table_.isEmpty()) {
+    if (changed_albums_unknown_) {
+      changed_albums_unknown_ = false;
+      QSqlQuery q(db);
+      q.prepare(QString("SELECT DISTINCT album FROM %1 WHERE unavailable = 0").arg(songs_table_));
+      q.exec();
+      if (!db_->CheckErrors(q)) {
+        while (q.next()) albums << q.value(0).toString();
+      }
+    }
+    albums.unite(changed_albums_);
+    changed_albums_.clear();
+    return albums;
+  }
+
+  // The rows are only removed by ClearChangedAlbums() in the transaction updating the compilations, so they are kept if it's rolled back.
+  QSqlQuery q(db);
+  q.prepare(QString("SELECT album FROM %1").arg(changed_albums_table_));
+  q.exec();
+  if (db_->CheckErrors(q)) return albums;
+  while (q.next()) albums << q.value(0).toString();
+
+  return albums;
+
+}
+
+void CollectionBackend::ClearChangedAlbums(QSqlDatabase &db) {
+
+  if (changed_albums_table_.isEmpty()) return;
+
+  QSqlQuery q(db);
+  q.prepare(QString("DELETE FROM %1").arg(changed_albums_table_));
+  q.exec();
+  db_->CheckErrors(q);
+
+}
+
+void CollectionBackend::DeleteFingerprints(QSqlDatabase &db, const SongList &songs) {
+
+  if (fingerprints_table_.isEmpty()) return;
+
+  QSqlQuery q(db);
+  q.prepare(QString("DELETE FROM %1 WHERE filename = :filename").arg(fingerprints_table_));
+  for (const Song &song : songs) {
+    if (!song.url().isLocalFile()) continue;
+    q.bindValue(":filename", song.url().toLocalFile());
+    q.exec();
+    if (db_->CheckErrors(q)) return;
+  }
+
+}
+
+QByteArray CollectionBackend::GetArtThumbnail(const QUrl &url) {
+
+  if (art_thumbnails_table_.isEmpty() || songs_art_thumbnails_table_.isEmpty()) return QByteArray();
+
+  // This is called from the cover loader workers, with a connection of their own.
+  // Take the database mutex like every other accessor: reading while a scan is writing could otherwise fail with SQLITE_BUSY.
+  // A worker may wait for a write transaction to finish, but covers it already loaded come from the image caches without getting here.
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  QSqlQuery q(db);
+  q.prepare(QString("SELECT %1.thumbnail FROM %2 JOIN %1 ON %1.hash = %2.hash WHERE %2.filename = :filename").arg(art_thumbnails_table_, songs_art_thumbnails_table_));
+  q.bindValue(":filename", url.toEncoded());
+  q.exec();
+  if (db_->CheckErrors(q) || !q.next()) return QByteArray();
+
+  return q.value(0).toByteArray();
 
 }
 
@@ -391,9 +669,10 @@ void CollectionBackend::AddOrUpdateSongs(const SongList &songs) {
   QSqlQuery check_dir(db);
   check_dir.prepare(QString("SELECT ROWID FROM %1 WHERE ROWID = :id").arg(dirs_table_));
   QSqlQuery add_song(db);
-  add_song.prepare(QString("INSERT INTO %1 (" + Song::kColumnSpec + ") VALUES (" + Song::kBindSpec + ")").arg(songs_table_));
+  // The duplicate key is only used to find duplicates in the collection, it's never read back into a song.
+  add_song.prepare(QString("INSERT INTO %1 (" + Song::kColumnSpec + ", duplicate_key) VALUES (" + Song::kBindSpec + ", :duplicate_key)").arg(songs_table_));
   QSqlQuery update_song(db);
-  update_song.prepare(QString("UPDATE %1 SET " + Song::kUpdateSpec + " WHERE ROWID = :id").arg(songs_table_));
+  update_song.prepare(QString("UPDATE %1 SET " + Song::kUpdateSpec + ", duplicate_key = :duplicate_key WHERE ROWID = :id").arg(songs_table_));
   QSqlQuery add_song_fts(db);
   add_song_fts.prepare(QString("INSERT INTO %1 (ROWID, " + Song::kFtsColumnSpec + ") VALUES (:id, " + Song::kFtsBindSpec + ")").arg(fts_table_));
   QSqlQuery update_song_fts(db);
@@ -403,6 +682,8 @@ void CollectionBackend::AddOrUpdateSongs(const SongList &songs) {
 
   SongList added_songs;
   SongList deleted_songs;
+  QSet<QString> albums;
+  QList<SongCountChange> count_changes;
 
   for (const Song &song : songs) {
     // Do a sanity check first - make sure the song's directory still exists
@@ -420,6 +701,7 @@ void CollectionBackend::AddOrUpdateSongs(const SongList &songs) {
 
       // Insert the row and create a new ID
       song.BindToQuery(&add_song);
+      add_song.bindValue(":duplicate_key", Song::DuplicateKey(song.artist(), song.album(), song.title()));
       add_song.exec();
       if (db_->CheckErrors(add_song)) continue;
 
@@ -435,6 +717,8 @@ void CollectionBackend::AddOrUpdateSongs(const SongList &songs) {
       Song copy(song);
       copy.set_id(id);
       added_songs << copy;
+      albums.insert(song.album());
+      if (!song.is_unavailable()) count_changes << SongCountChange(song.artist(), song.album(), 1);
     }
     else {
       // Get the previous song data first
@@ -443,6 +727,7 @@ void CollectionBackend::AddOrUpdateSongs(const SongList &songs) {
 
       // Update
       song.BindToQuery(&update_song);
+      update_song.bindValue(":duplicate_key", Song::DuplicateKey(song.artist(), song.album(), song.title()));
       update_song.bindValue(":id", song.id());
       update_song.exec();
       if (db_->CheckErrors(update_song)) continue;
@@ -454,10 +739,18 @@ void CollectionBackend::AddOrUpdateSongs(const SongList &songs) {
 
       deleted_songs << old_song;
       added_songs << song;
+      albums.insert(old_song.album());
+      albums.insert(song.album());
+      if (!old_song.is_unavailable()) count_changes << SongCountChange(old_song.artist(), old_song.album(), -1);
+      if (!song.is_unavailable()) count_changes << SongCountChange(song.artist(), song.album(), 1);
     }
   }
 
-  transaction.Commit();
+  UpdateAlbums(db, albums);
+  AddChangedAlbums(db, albums);
+
+  // The counts must not include changes that were rolled back.
+  if (transaction.Commit()) AdjustSongCounts(count_changes);
 
   if (!deleted_songs.isEmpty()) emit SongsDeleted(deleted_songs);
 
@@ -493,13 +786,28 @@ void CollectionBackend::DeleteSongs(const SongList &songs) {
   QMutexLocker l(db_->Mutex());
   QSqlDatabase db(db_->Connect());
 
+  QSqlQuery find(db);
+  find.prepare(QString("SELECT artist, album, unavailable FROM %1 WHERE ROWID = :id").arg(songs_table_));
   QSqlQuery remove(db);
   remove.prepare(QString("DELETE FROM %1 WHERE ROWID = :id").arg(songs_table_));
   QSqlQuery remove_fts(db);
   remove_fts.prepare(QString("DELETE FROM %1 WHERE ROWID = :id").arg(fts_table_));
 
+  QSet<QString> albums;
+  QList<SongCountChange> count_changes;
+
   ScopedTransaction transaction(&db);
+  DeleteFingerprints(db, songs);
   for (const Song &song : songs) {
+    // The song passed in might be out of date, so count what is actually removed.
+    if (song_counts_loaded_) {
+      find.bindValue(":id", song.id());
+      find.exec();
+      if (!db_->CheckErrors(find) && find.next() && !find.value(2).toBool()) {
+        count_changes << SongCountChange(find.value(0).toString(), find.value(1).toString(), -1);
+      }
+    }
+
     remove.bindValue(":id", song.id());
     remove.exec();
     db_->CheckErrors(remove);
@@ -507,8 +815,14 @@ void CollectionBackend::DeleteSongs(const SongList &songs) {
     remove_fts.bindValue(":id", song.id());
     remove_fts.exec();
     db_->CheckErrors(remove_fts);
+
+    albums.insert(song.album());
   }
-  transaction.Commit();
+
+  UpdateAlbums(db, albums);
+  AddChangedAlbums(db, albums);
+
+  if (transaction.Commit()) AdjustSongCounts(count_changes);
 
   emit SongsDeleted(songs);
 
@@ -523,16 +837,36 @@ void CollectionBackend::MarkSongsUnavailable(const SongList &songs, bool unavail
   QMutexLocker l(db_->Mutex());
   QSqlDatabase db(db_->Connect());
 
+  QSqlQuery find(db);
+  find.prepare(QString("SELECT artist, album, unavailable FROM %1 WHERE ROWID = :id").arg(songs_table_));
   QSqlQuery remove(db);
   remove.prepare(QString("UPDATE %1 SET unavailable = %2 WHERE ROWID = :id").arg(songs_table_).arg(int(unavailable)));
 
+  QSet<QString> albums;
+  QList<SongCountChange> count_changes;
+
   ScopedTransaction transaction(&db);
+  if (unavailable) DeleteFingerprints(db, songs);
   for (const Song &song : songs) {
+    if (song_counts_loaded_) {
+      find.bindValue(":id", song.id());
+      find.exec();
+      if (!db_->CheckErrors(find) && find.next() && find.value(2).toBool() != unavailable) {
+        count_changes << SongCountChange(find.value(0).toString(), find.value(1).toString(), unavailable ? -1 : 1);
+      }
+    }
+
     remove.bindValue(":id", song.id());
     remove.exec();
     db_->CheckErrors(remove);
+
+    albums.insert(song.album());
   }
-  transaction.Commit();
+
+  UpdateAlbums(db, albums);
+  AddChangedAlbums(db, albums);
+
+  if (transaction.Commit()) AdjustSongCounts(count_changes);
 
   emit SongsDeleted(songs);
   UpdateTotalSongCountAsync();
@@ -749,6 +1083,51 @@ SongList CollectionBackend::GetSongsByUrl(const QUrl &url) {
 
 }
 
+SongList CollectionBackend::GetSongsByUrls(const QList<QUrl> &urls) {
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  // Put the filenames in a temporary table and select against that, instead of doing one query for each filename.
+  QSqlQuery q(db);
+  q.prepare("CREATE TEMP TABLE IF NOT EXISTS url_lookup (filename TEXT NOT NULL)");
+  q.exec();
+  if (db_->CheckErrors(q)) return SongList();
+
+  ScopedTransaction transaction(&db);
+
+  q = QSqlQuery(db);
+  q.prepare("INSERT INTO temp.url_lookup (filename) VALUES (:filename)");
+  for (const QUrl &url : urls) {
+    q.bindValue(":filename", url.toString());
+    q.exec();
+    if (db_->CheckErrors(q)) return SongList();
+  }
+
+  q = QSqlQuery(db);
+  q.setForwardOnly(true);
+  q.prepare(QString("SELECT ROWID, " + Song::kColumnSpec + " FROM %1 WHERE filename IN (SELECT filename FROM temp.url_lookup) AND unavailable = 0").arg(songs_table_));
+  q.exec();
+  if (db_->CheckErrors(q)) return SongList();
+
+  SongList songs;
+  while (q.next()) {
+    Song song;
+    song.InitFromQuery(SqlRow(q), true);
+    songs << song;
+  }
+
+  q = QSqlQuery(db);
+  q.prepare("DELETE FROM temp.url_lookup");
+  q.exec();
+  if (db_->CheckErrors(q)) return songs;
+
+  transaction.Commit();
+
+  return songs;
+
+}
+
 CollectionBackend::AlbumList CollectionBackend::GetCompilationAlbums(const QueryOptions &opt) {
   return GetAlbums(QString(), QString(), true, opt);
 }
@@ -778,33 +1157,13 @@ void CollectionBackend::UpdateCompilations() {
   QMutexLocker l(db_->Mutex());
   QSqlDatabase db(db_->Connect());
 
-  // Look for albums that have songs by more than one 'effective album artist' in the same directory
+  // Only albums that had songs added, changed or removed since the last run can have changed, so only those are looked at again.
+  const QSet<QString> albums = TakeChangedAlbums(db);
+  if (albums.isEmpty()) return;
 
+  // Look for albums that have songs by more than one 'effective album artist' in the same directory
   QSqlQuery q(db);
-  q.prepare(QString("SELECT effective_albumartist, album, filename, compilation_detected FROM %1 WHERE unavailable = 0 ORDER BY album").arg(songs_table_));
-  q.exec();
-  if (db_->CheckErrors(q)) return;
-
-  QMap<QString, CompilationInfo> compilation_info;
-  while (q.next()) {
-    QString artist = q.value(0).toString();
-    QString album = q.value(1).toString();
-    QString filename = q.value(2).toString();
-    bool compilation_detected = q.value(3).toBool();
-
-    // Ignore songs that don't have an album field set
-    if (album.isEmpty()) continue;
-
-    // Find the directory the song is in
-    int last_separator = filename.lastIndexOf('/');
-    if (last_separator == -1) continue;
-
-    CompilationInfo &info = compilation_info[album];
-    info.artists.insert(artist);
-    info.directories.insert(filename.left(last_separator));
-    if (compilation_detected) info.has_compilation_detected = true;
-    else info.has_not_compilation_detected = true;
-  }
+  q.prepare(QString("SELECT effective_albumartist, filename, compilation_detected FROM %1 WHERE album = :album AND unavailable = 0").arg(songs_table_));
 
   // Now mark the songs that we think are in compilations
   QSqlQuery update(db);
@@ -814,26 +1173,56 @@ void CollectionBackend::UpdateCompilations() {
 
   SongList deleted_songs;
   SongList added_songs;
+  QSet<QString> updated_albums;
 
   ScopedTransaction transaction(&db);
+  ClearChangedAlbums(db);
+
+  for (const QString &album : albums) {
+    // Ignore songs that don't have an album field set
+    if (album.isEmpty()) continue;
 
-  QMap<QString, CompilationInfo>::const_iterator it = compilation_info.constBegin();
-  for (; it != compilation_info.constEnd(); ++it) {
-    const CompilationInfo &info = it.value();
-    QString album(it.key());
+    q.bindValue(":album", album);
+    q.exec();
+    if (db_->CheckErrors(q)) continue;
+
+    CompilationInfo info;
+    bool has_songs = false;
+    while (q.next()) {
+      QString artist = q.value(0).toString();
+      QString filename = q.value(1).toString();
+      bool compilation_detected = q.value(2).toBool();
+
+      // Find the directory the song is in
+      int last_separator = filename.lastIndexOf('/');
+      if (last_separator == -1) continue;
+
+      has_songs = true;
+      info.artists.insert(artist);
+      info.directories.insert(filename.left(last_separator));
+      if (compilation_detected) info.has_compilation_detected = true;
+      else info.has_not_compilation_detected = true;
+    }
+    if (!has_songs) continue;
 
     // If there were more 'effective album artists' than there were directories for this album then it's a compilation.
 
     if (info.artists.count() > info.directories.count()) {
-      if (info.has_not_compilation_detected)
+      if (info.has_not_compilation_detected) {
         UpdateCompilations(find_songs, update, deleted_songs, added_songs, album, 1);
+        updated_albums << album;
+      }
     }
     else {
-      if (info.has_compilation_detected)
+      if (info.has_compilation_detected) {
         UpdateCompilations(find_songs, update, deleted_songs, added_songs, album, 0);
+        updated_albums << album;
+      }
     }
   }
 
+  UpdateAlbums(db, updated_albums);
+
   transaction.Commit();
 
   if (!deleted_songs.isEmpty()) {
@@ -865,6 +1254,11 @@ void CollectionBackend::UpdateCompilations(QSqlQuery &find_songs, QSqlQuery &upd
 
 CollectionBackend::AlbumList CollectionBackend::GetAlbums(const QString &artist, const QString &album_artist, bool compilation, const QueryOptions &opt) {
 
+  // The albums table can answer anything that isn't filtered on the songs.
+  if (!albums_table_.isEmpty() && artist.isEmpty() && opt.filter().isEmpty() && opt.max_age() == -1 && opt.query_mode() == QueryOptions::QueryMode_All) {
+    return GetAlbumsFromAlbumsTable(album_artist, compilation);
+  }
+
   AlbumList ret;
 
   CollectionQuery query(opt);
@@ -876,7 +1270,7 @@ CollectionBackend::AlbumList CollectionBackend::GetAlbums(const QString &artist,
   }
   else if (!album_artist.isNull() && !album_artist.isEmpty()) {
     query.AddCompilationRequirement(false);
-    query.AddWhere("albumartist", album_artist);
+    query.AddWhere("effective_albumartist", album_artist);
   }
   else if (!artist.isNull() && !artist.isEmpty()) {
     query.AddCompilationRequirement(false);
@@ -916,6 +1310,63 @@ CollectionBackend::AlbumList CollectionBackend::GetAlbums(const QString &artist,
 
 }
 
+CollectionBackend::AlbumList CollectionBackend::GetAlbumsFromAlbumsTable(const QString &album_artist, bool compilation) {
+
+  AlbumList ret;
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  QString sql(QString("SELECT album, artist, albumartist, art_automatic, art_manual, filename FROM %1").arg(albums_table_));
+  if (compilation) {
+    sql += " WHERE compilation = 1";
+  }
+  else if (!album_artist.isEmpty()) {
+    sql += " WHERE compilation = 0 AND effective_albumartist = :albumartist";
+  }
+  sql += " ORDER BY album";
+
+  QSqlQuery q(db);
+  q.setForwardOnly(true);
+  q.prepare(sql);
+  if (!compilation && !album_artist.isEmpty()) {
+    q.bindValue(":albumartist", album_artist);
+  }
+  q.exec();
+  if (db_->CheckErrors(q)) return ret;
+
+  while (q.next()) {
+    ret << Album(q.value(1).toString(), q.value(2).toString(), q.value(0).toString(), q.value(3).toString(), q.value(4).toString(), QUrl::fromEncoded(q.value(5).toByteArray()));
+  }
+
+  return ret;
+
+}
+
+void CollectionBackend::UpdateAlbums(QSqlDatabase &db, const QSet<QString> &albums) {
+
+  if (albums_table_.isEmpty() || albums.isEmpty()) return;
+
+  // Rebuild the rows of each album from its songs, both tables are indexed on album so this stays cheap.
+  QSqlQuery remove(db);
+  remove.prepare(QString("DELETE FROM %1 WHERE album = :album").arg(albums_table_));
+  QSqlQuery add(db);
+  add.prepare(QString("INSERT INTO %1 (album, effective_albumartist, compilation, artist, albumartist, art_automatic, art_manual, filename, songs) "
+                      "SELECT album, CASE WHEN compilation_effective THEN '' ELSE IFNULL(effective_albumartist, '') END AS album_effective_albumartist, compilation_effective, CASE WHEN compilation_effective THEN '' ELSE artist END, CASE WHEN compilation_effective THEN '' ELSE albumartist END, art_automatic, art_manual, MIN(filename), COUNT(*) "
+                      "FROM %2 WHERE album = :album AND unavailable = 0 GROUP BY album_effective_albumartist, compilation_effective").arg(albums_table_, songs_table_));
+
+  for (const QString &album : albums) {
+    remove.bindValue(":album", album);
+    remove.exec();
+    if (db_->CheckErrors(remove)) continue;
+
+    add.bindValue(":album", album);
+    add.exec();
+    db_->CheckErrors(add);
+  }
+
+}
+
 CollectionBackend::Album CollectionBackend::GetAlbumArt(const QString &artist, const QString &albumartist, const QString &album) {
 
   Album ret;
@@ -1002,6 +1453,8 @@ void CollectionBackend::UpdateManualAlbumArt(const QString &artist, const QStrin
   q.exec();
   db_->CheckErrors(q);
 
+  UpdateAlbums(db, QSet<QString>() << album);
+
   // Now get the updated songs
   if (!ExecQuery(&query)) return;
 
@@ -1064,6 +1517,8 @@ void CollectionBackend::ForceCompilation(const QString &album, const QList<QStri
     }
   }
 
+  UpdateAlbums(db, QSet<QString>() << album);
+
   if (!added_songs.isEmpty() || !deleted_songs.isEmpty()) {
     emit SongsDeleted(deleted_songs);
     emit SongsDiscovered(added_songs);
@@ -1141,7 +1596,39 @@ void CollectionBackend::DeleteAll() {
     q.exec();
     if (db_->CheckErrors(q)) return;
 
-    t.Commit();
+    if (!albums_table_.isEmpty()) {
+      q = QSqlQuery("DELETE FROM " + albums_table_, db);
+      q.exec();
+      if (db_->CheckErrors(q)) return;
+    }
+
+    if (!changed_albums_table_.isEmpty()) {
+      q = QSqlQuery("DELETE FROM " + changed_albums_table_, db);
+      q.exec();
+      if (db_->CheckErrors(q)) return;
+    }
+
+    if (!fingerprints_table_.isEmpty()) {
+      q = QSqlQuery("DELETE FROM " + fingerprints_table_, db);
+      q.exec();
+      if (db_->CheckErrors(q)) return;
+    }
+
+    if (!art_thumbnails_table_.isEmpty() && !songs_art_thumbnails_table_.isEmpty()) {
+      q = QSqlQuery("DELETE FROM " + songs_art_thumbnails_table_, db);
+      q.exec();
+      if (db_->CheckErrors(q)) return;
+
+      q = QSqlQuery("DELETE FROM " + art_thumbnails_table_, db);
+      q.exec();
+      if (db_->CheckErrors(q)) return;
+    }
+
+    if (!t.Commit()) return;
+
+    song_count_ = 0;
+    artist_song_counts_.clear();
+    album_song_counts_.clear();
   }
 
   emit DatabaseReset();
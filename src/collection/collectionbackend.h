@@ -29,8 +29,11 @@
 #include <QObject>
 #include <QFileInfo>
 #include <QList>
+#include <QHash>
 #include <QVector>
 #include <QSet>
+#include <QMap>
+#include <QByteArray>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
@@ -109,6 +112,8 @@ class CollectionBackendInterface : public QObject {
   // Returns a section of a song with the given filename and beginning. If the section is not present in collection, returns invalid song.
   // Using default beginning value is suitable when searching for single-section songs.
   virtual Song GetSongByUrl(const QUrl &url, qint64 beginning = 0) = 0;
+  // Returns all sections of all songs with any of the given filenames, using a single query.
+  virtual SongList GetSongsByUrls(const QList<QUrl> &urls) = 0;
 
   virtual void AddDirectory(const QString &path) = 0;
   virtual void RemoveDirectory(const Directory &dir) = 0;
@@ -121,15 +126,17 @@ class CollectionBackend : public CollectionBackendInterface {
 
  public:
   static const char *kSettingsGroup;
+  static const int kArtThumbnailSize;
 
   Q_INVOKABLE CollectionBackend(QObject *parent = nullptr);
-  void Init(Database *db, const QString &songs_table, const QString &dirs_table, const QString &subdirs_table, const QString &fts_table);
+  void Init(Database *db, const QString &songs_table, const QString &dirs_table, const QString &subdirs_table, const QString &fts_table, const QString &albums_table = QString(), const QString &art_thumbnails_table = QString(), const QString &songs_art_thumbnails_table = QString(), const QString &fingerprints_table = QString(), const QString &changed_albums_table = QString());
 
   Database *db() const { return db_; }
 
   QString songs_table() const { return songs_table_; }
   QString dirs_table() const { return dirs_table_; }
   QString subdirs_table() const { return subdirs_table_; }
+  QString albums_table() const { return albums_table_; }
 
   // Get a list of directories in the collection.  Emits DirectoriesDiscovered.
   void LoadDirectoriesAsync();
@@ -137,6 +144,12 @@ class CollectionBackend : public CollectionBackendInterface {
   void UpdateTotalSongCountAsync();
   void UpdateTotalArtistCountAsync();
   void UpdateTotalAlbumCountAsync();
+  void UpdateDuplicateKeysAsync();
+  void DeleteUnusedArtThumbnailsAsync();
+
+  // Number of available songs by the artist or on the album, only counting committed changes.
+  int ArtistSongCount(const QString &artist);
+  int AlbumSongCount(const QString &album);
 
   SongList FindSongsInDirectory(int id);
   SubdirectoryList SubdirsInDirectory(int id);
@@ -159,6 +172,10 @@ class CollectionBackend : public CollectionBackendInterface {
   void UpdateManualAlbumArtAsync(const QString &artist, const QString &albumartist, const QString &album, const QString &art);
   Album GetAlbumArt(const QString &artist, const QString &albumartist, const QString &album);
 
+  // Returns the JPEG encoded thumbnail of the art embedded in the file, stored when the file was scanned.
+  // Can be called from any thread.
+  QByteArray GetArtThumbnail(const QUrl &url);
+
   Song GetSongById(int id);
   SongList GetSongsById(const QList<int> &ids);
   SongList GetSongsById(const QStringList &ids);
@@ -166,6 +183,7 @@ class CollectionBackend : public CollectionBackendInterface {
 
   SongList GetSongsByUrl(const QUrl &url);
   Song GetSongByUrl(const QUrl &url, qint64 beginning = 0);
+  SongList GetSongsByUrls(const QList<QUrl> &urls);
 
   void AddDirectory(const QString &path);
   void RemoveDirectory(const Directory &dir);
@@ -184,6 +202,9 @@ class CollectionBackend : public CollectionBackendInterface {
   void UpdateTotalSongCount();
   void UpdateTotalArtistCount();
   void UpdateTotalAlbumCount();
+  void UpdateDuplicateKeys();
+  void UpdateArtThumbnails(const QMap<QString, QByteArray> &thumbnails);
+  void DeleteUnusedArtThumbnails();
   void AddOrUpdateSongs(const SongList &songs);
   void UpdateMTimesOnly(const SongList &songs);
   void DeleteSongs(const SongList &songs);
@@ -200,6 +221,8 @@ class CollectionBackend : public CollectionBackendInterface {
 signals:
   void DirectoryDiscovered(const Directory &dir, const SubdirectoryList &subdirs);
   void DirectoryDeleted(const Directory &dir);
+  // Emitted by LoadDirectories() after DirectoryDiscovered was emitted for every directory.
+  void DirectoriesLoaded();
 
   void SongsDiscovered(const SongList &songs);
   void SongsDeleted(const SongList &songs);
@@ -223,17 +246,54 @@ signals:
 
   void UpdateCompilations(QSqlQuery &find_songs, QSqlQuery &update, SongList &deleted_songs, SongList &added_songs, const QString &album, int compilation_detected);
   AlbumList GetAlbums(const QString &artist, const QString &album_artist, bool compilation = false, const QueryOptions &opt = QueryOptions());
+  AlbumList GetAlbumsFromAlbumsTable(const QString &album_artist, bool compilation);
+  void UpdateAlbums(QSqlDatabase &db, const QSet<QString> &albums);
+  void DeleteFingerprints(QSqlDatabase &db, const SongList &songs);
+  void AddChangedAlbums(QSqlDatabase &db, const QSet<QString> &albums);
+  QSet<QString> TakeChangedAlbums(QSqlDatabase &db);
+  void ClearChangedAlbums(QSqlDatabase &db);
   SubdirectoryList SubdirsInDirectory(int id, QSqlDatabase &db);
 
   Song GetSongById(int id, QSqlDatabase &db);
   SongList GetSongsById(const QStringList &ids, QSqlDatabase &db);
 
+  bool LoadSongCounts();
+  struct SongCountChange {
+    SongCountChange(const QString &_artist, const QString &_album, const int _songs) : artist(_artist), album(_album), songs(_songs) {}
+
+    QString artist;
+    QString album;
+    int songs;
+  };
+  void AdjustSongCounts(const QList<SongCountChange> &changes);
+
  private:
   Database *db_;
   QString songs_table_;
   QString dirs_table_;
   QString subdirs_table_;
   QString fts_table_;
+  // Optional table with one row per album, kept up to date by the functions writing songs.
+  QString albums_table_;
+  // Optional tables with the embedded art thumbnails, stored once per distinct image and mapped to the files by filename.
+  QString art_thumbnails_table_;
+  QString songs_art_thumbnails_table_;
+  // Optional table with the cached fingerprints of the files, pruned when songs are removed.
+  QString fingerprints_table_;
+
+  // Optional table with the albums that had songs added, changed or removed since compilations were last updated.
+  // It's written in the same transaction as the songs, so albums aren't forgotten when the application quits before the update.
+  QString changed_albums_table_;
+  // Used instead of the table when there is none, protected by the database mutex.
+  QSet<QString> changed_albums_;
+  // Set until the first compilation update when the changed albums aren't stored, then all albums are looked at once.
+  bool changed_albums_unknown_;
+
+  // Counts of the available songs, loaded once and then kept up to date by the functions writing songs, protected by the database mutex.
+  bool song_counts_loaded_;
+  int song_count_;
+  QHash<QString, int> artist_song_counts_;
+  QHash<QString, int> album_song_counts_;
 
 };
 
@@ -302,9 +302,6 @@ void CollectionFilterWidget::SetFilterHint(const QString &hint) {
 
 void CollectionFilterWidget::SetQueryMode(QueryOptions::QueryMode query_mode) {
 
-  ui_->filter->clear();
-  ui_->filter->setEnabled(query_mode == QueryOptions::QueryMode_All);
-
   model_->SetFilterQueryMode(query_mode);
 
 }
@@ -87,13 +87,11 @@ CollectionQuery::CollectionQuery(const QueryOptions &options)
     bound_values_ << cutoff;
   }
 
-  // TODO: Currently you cannot use any QueryMode other than All and fts at the same time.
-  // Joining songs, duplicated_songs and songs_fts all together takes a huge amount of time.
-  // The query takes about 20 seconds on my machine then. Why?
-  // Untagged mode could work with additional filtering but I'm disabling it just to be consistent
-  // this way filtering is available only in the All mode.
-  // Remember though that when you fix the Duplicates + FTS cooperation, enable the filtering in both Duplicates and Untagged modes.
-  duplicates_only_ = options.query_mode() == QueryOptions::QueryMode_Duplicates;
+  // Songs with the same duplicate key are duplicates, the keys that occur more than once are found from the index alone.
+  // When joining with fts the unary + keeps sqlite from using the index for the outer table, otherwise it runs the fts match once for every duplicate.
+  if (options.query_mode() == QueryOptions::QueryMode_Duplicates) {
+    where_clauses_ << QString("%1%songs_table.duplicate_key IN (SELECT duplicate_key FROM %songs_table AS dup_songs WHERE duplicate_key IS NOT NULL AND unavailable = 0 GROUP BY duplicate_key HAVING COUNT(*) > 1)").arg(join_with_fts_ ? "+" : "");
+  }
 
   if (options.query_mode() == QueryOptions::QueryMode_Untagged) {
     where_clauses_ << "(artist = '' OR album = '' OR title ='')";
@@ -101,15 +99,6 @@ CollectionQuery::CollectionQuery(const QueryOptions &options)
 
 }
 
-QString CollectionQuery::GetInnerQuery() {
-  return duplicates_only_
-             ? QString(" INNER JOIN (select * from duplicated_songs) dsongs        "
-                   "ON (%songs_table.artist = dsongs.dup_artist       "
-                   "AND %songs_table.album = dsongs.dup_album     "
-                   "AND %songs_table.title = dsongs.dup_title)    ")
-             : QString();
-}
-
 void CollectionQuery::AddWhere(const QString &column, const QVariant &value, const QString &op) {
 
   // ignore 'literal' for IN
@@ -151,7 +140,7 @@ QSqlQuery CollectionQuery::Exec(QSqlDatabase db, const QString &songs_table, con
     sql = QString("SELECT %1 FROM %2 INNER JOIN %3 AS fts ON %2.ROWID = fts.ROWID").arg(column_spec_, songs_table, fts_table);
   }
   else {
-    sql = QString("SELECT %1 FROM %2 %3").arg(column_spec_, songs_table, GetInnerQuery());
+    sql = QString("SELECT %1 FROM %2").arg(column_spec_, songs_table);
   }
 
   QStringList where_clauses(where_clauses_);
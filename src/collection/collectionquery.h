@@ -39,9 +39,9 @@ class CollectionBackend;
 struct QueryOptions {
   // Modes of CollectionQuery:
   // - use the all songs table
-  // - use the duplicated songs view; by duplicated we mean those songs for which the (artist, album, title) tuple is found more than once in the songs table
+  // - use the duplicated songs; by duplicated we mean those songs for which the (artist, album, title) tuple, ignoring case and whitespace, is found more than once in the songs table
   // - use the untagged songs view; by untagged we mean those for which at least one of the (artist, album, title) tags is empty
-  // Please note that additional filtering based on fts table (the filter attribute) won't work in Duplicates and Untagged modes.
+  // The filter attribute can be combined with any of the modes.
   enum QueryMode {
     QueryMode_All,
     QueryMode_Duplicates,
@@ -53,19 +53,13 @@ struct QueryOptions {
   bool Matches(const Song &song) const;
 
   QString filter() const { return filter_; }
-  void set_filter(const QString &filter) {
-    this->filter_ = filter;
-    this->query_mode_ = QueryMode_All;
-  }
+  void set_filter(const QString &filter) { this->filter_ = filter; }
 
   int max_age() const { return max_age_; }
   void set_max_age(int max_age) { this->max_age_ = max_age; }
 
   QueryMode query_mode() const { return query_mode_; }
-  void set_query_mode(QueryMode query_mode) {
-    this->query_mode_ = query_mode;
-    this->filter_ = QString();
-  }
+  void set_query_mode(QueryMode query_mode) { this->query_mode_ = query_mode; }
 
  private:
   QString filter_;
@@ -97,8 +91,6 @@ class CollectionQuery {
   operator const QSqlQuery &() const { return query_; }
 
  private:
-  QString GetInnerQuery();
-
   bool include_unavailable_;
   bool join_with_fts_;
   QString column_spec_;
@@ -106,7 +98,6 @@ class CollectionQuery {
   QStringList where_clauses_;
   QVariantList bound_values_;
   int limit_;
-  bool duplicates_only_;
 
   QSqlQuery query_;
 };
@@ -32,6 +32,7 @@
 #include <QMap>
 #include <QList>
 #include <QSet>
+#include <QByteArray>
 #include <QTimer>
 #include <QVariant>
 #include <QString>
@@ -130,6 +131,8 @@ CollectionWatcher::ScanTransaction::~ScanTransaction() {
   if (!touched_subdirs.isEmpty())
     emit watcher_->SubdirsMTimeUpdated(touched_subdirs);
 
+  if (!art_thumbnails.isEmpty()) emit watcher_->ArtThumbnailsUpdated(art_thumbnails);
+
   watcher_->task_manager_->SetTaskFinished(task_id_);
 
   if (watcher_->monitor_) {
@@ -377,7 +380,7 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const Subdirectory
     }
     else {
       // The song is on disk but not in the DB
-      SongList song_list = ScanNewFile(file, path, matching_cue, &cues_processed);
+      SongList song_list = ScanNewFile(file, path, matching_cue, &cues_processed, t);
 
       if (song_list.isEmpty()) {
         continue;
@@ -480,7 +483,15 @@ void CollectionWatcher::UpdateNonCueAssociatedSong(const QString &file, const So
   Song song_on_disk;
   song_on_disk.set_source(source_);
   song_on_disk.set_directory_id(t->dir());
-  TagReaderClient::Instance()->ReadFileBlocking(file, &song_on_disk);
+  if (source_ == Song::Source_Collection) {
+    QByteArray thumbnail;
+    TagReaderClient::Instance()->ReadFileBlocking(file, &song_on_disk, CollectionBackend::kArtThumbnailSize, &thumbnail);
+    // Store an empty thumbnail too, so art removed from the file is also removed from the collection.
+    if (song_on_disk.is_valid()) t->art_thumbnails.insert(QUrl::fromLocalFile(file).toEncoded(), thumbnail);
+  }
+  else {
+    TagReaderClient::Instance()->ReadFileBlocking(file, &song_on_disk);
+  }
 
   if (song_on_disk.is_valid()) {
     PreserveUserSetData(file, image, matching_song, &song_on_disk, t);
@@ -488,7 +499,7 @@ void CollectionWatcher::UpdateNonCueAssociatedSong(const QString &file, const So
 
 }
 
-SongList CollectionWatcher::ScanNewFile(const QString &file, const QString &path, const QString &matching_cue, QSet<QString> *cues_processed) {
+SongList CollectionWatcher::ScanNewFile(const QString &file, const QString &path, const QString &matching_cue, QSet<QString> *cues_processed, ScanTransaction *t) {
 
   SongList song_list;
 
@@ -521,7 +532,14 @@ SongList CollectionWatcher::ScanNewFile(const QString &file, const QString &path
   }
   else {
     Song song;
-    TagReaderClient::Instance()->ReadFileBlocking(file, &song);
+    if (source_ == Song::Source_Collection) {
+      QByteArray thumbnail;
+      TagReaderClient::Instance()->ReadFileBlocking(file, &song, CollectionBackend::kArtThumbnailSize, &thumbnail);
+      if (song.is_valid() && !thumbnail.isEmpty()) t->art_thumbnails.insert(QUrl::fromLocalFile(file).toEncoded(), thumbnail);
+    }
+    else {
+      TagReaderClient::Instance()->ReadFileBlocking(file, &song);
+    }
 
     if (song.is_valid()) {
       song_list << song;
@@ -30,6 +30,7 @@
 #include <QHash>
 #include <QMap>
 #include <QSet>
+#include <QByteArray>
 #include <QString>
 #include <QStringList>
 #include <QTimer>
@@ -66,6 +67,7 @@ signals:
   void SongsReadded(const SongList &songs, bool unavailable = false);
   void SubdirsDiscovered(const SubdirectoryList &subdirs);
   void SubdirsMTimeUpdated(const SubdirectoryList &subdirs);
+  void ArtThumbnailsUpdated(const QMap<QString, QByteArray> &thumbnails);
   void CompilationsNeedUpdating();
 
   void ScanStarted(int task_id);
@@ -107,6 +109,8 @@ signals:
     SongList touched_songs;
     SubdirectoryList new_subdirs;
     SubdirectoryList touched_subdirs;
+    // Embedded art thumbnails read together with the tags, keyed by encoded URL. An empty thumbnail removes it.
+    QMap<QString, QByteArray> art_thumbnails;
 
    private:
     ScanTransaction(const ScanTransaction&) {}
@@ -159,7 +163,7 @@ signals:
   void PreserveUserSetData(const QString &file, const QString &image, const Song &matching_song, Song *out, ScanTransaction *t);
   // Scans a single media file that's present on the disk but not yet in the collection.
   // It may result in a multiple files added to the collection when the media file has many sections (like a CUE related media file).
-  SongList ScanNewFile(const QString &file, const QString &path, const QString &matching_cue, QSet<QString> *cues_processed);
+  SongList ScanNewFile(const QString &file, const QString &path, const QString &matching_cue, QSet<QString> *cues_processed, ScanTransaction *t);
 
  private:
   Song::Source source_;
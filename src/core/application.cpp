@@ -30,9 +30,11 @@
 #include <QThread>
 #include <QVariant>
 #include <QString>
+#include <QTimer>
 
 #include "core/closure.h"
 #include "core/lazy.h"
+#include "core/startuptrace.h"
 #include "core/tagreaderclient.h"
 #include "core/song.h"
 
@@ -77,7 +79,6 @@ class ApplicationImpl {
        tag_reader_client_([=]() {
           TagReaderClient *client = new TagReaderClient(app);
           app->MoveToNewThread(client);
-          client->Start();
           return client;
         }),
         database_([=]() {
@@ -89,7 +90,11 @@ class ApplicationImpl {
         appearance_([=]() { return new Appearance(app); }),
         task_manager_([=]() { return new TaskManager(app); }),
         player_([=]() { return new Player(app, app); }),
-        enginedevice_([=]() { return new EngineDevice(app); }),
+        enginedevice_([=]() {
+          EngineDevice *enginedevice = new EngineDevice(app);
+          enginedevice->Init();
+          return enginedevice;
+        }),
 #ifndef Q_OS_WIN
         device_manager_([=]() { return new DeviceManager(app, app); }),
 #endif
@@ -160,10 +165,14 @@ class ApplicationImpl {
 Application::Application(QObject *parent)
     : QObject(parent), p_(new ApplicationImpl(this)) {
 
-  enginedevice()->Init();
-  collection()->Init();
+  // The tagreader client is used through its instance from the start, e.g. for files passed on the command line.
+  // Only its workers are started after the first frame, unless a request comes in before that.
   tag_reader_client();
 
+  // The output devices are only listed when they are first needed, the tagreader workers and the collection watcher are started after the first frame.
+  AddDeferredStartup("Tagreader", [=]() { tag_reader_client()->Start(); });
+  AddDeferredStartup("Collection watcher", [=]() { collection()->Init(); });
+
 }
 
 Application::~Application() {
@@ -198,6 +207,32 @@ void Application::MoveToThread(QObject *object, QThread *thread) {
   object->moveToThread(thread);
 }
 
+void Application::AddDeferredStartup(const QString &name, std::function<void()> function) {
+  deferred_startup_ << qMakePair(name, function);
+}
+
+void Application::StartDeferredStartup() {
+  QTimer::singleShot(0, this, SLOT(RunDeferredStartup()));
+}
+
+void Application::RunDeferredStartup() {
+
+  if (deferred_startup_.isEmpty()) {
+    StartupTrace::Write();
+    return;
+  }
+
+  QPair<QString, std::function<void()>> stage = deferred_startup_.takeFirst();
+  {
+    StartupTrace::Phase phase(stage.first);
+    stage.second();
+  }
+
+  // Go back to the event loop between stages, so input and painting are handled in between.
+  QTimer::singleShot(0, this, SLOT(RunDeferredStartup()));
+
+}
+
 void Application::AddError(const QString& message) { emit ErrorAdded(message); }
 void Application::ReloadSettings() { emit SettingsChanged(); }
 void Application::OpenSettingsDialogAtPage(SettingsDialog::Page page) { emit SettingsDialogRequested(page); }
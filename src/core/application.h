@@ -26,11 +26,13 @@
 #include "config.h"
 
 #include <memory>
+#include <functional>
 #include <stdbool.h>
 
 #include <QObject>
 #include <QThread>
 #include <QList>
+#include <QPair>
 #include <QString>
 
 #include "settings/settingsdialog.h"
@@ -102,6 +104,10 @@ class Application : public QObject {
   void MoveToNewThread(QObject *object);
   void MoveToThread(QObject *object, QThread *thread);
 
+  // Startup work that isn't needed to show the first frame is queued here and run one stage at a time from the event loop after StartDeferredStartup().
+  void AddDeferredStartup(const QString &name, std::function<void()> function);
+  void StartDeferredStartup();
+
  public slots:
   void AddError(const QString &message);
   void ReloadSettings();
@@ -112,9 +118,13 @@ signals:
   void SettingsChanged();
   void SettingsDialogRequested(SettingsDialog::Page page);
 
+ private slots:
+  void RunDeferredStartup();
+
  private:
   std::unique_ptr<ApplicationImpl> p_;
   QList<QThread*> threads_;
+  QList<QPair<QString, std::function<void()>>> deferred_startup_;
 
 };
 
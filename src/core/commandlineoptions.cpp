@@ -72,7 +72,15 @@ const char *CommandlineOptions::kHelpText =
     "      --quiet               %29\n"
     "      --verbose             %30\n"
     "      --log-levels <levels> %31\n"
-    "      --version             %32\n";
+    "      --version             %32\n"
+    "      --startup-trace <file> %33\n"
+    "\n"
+    "%34:\n"
+    "      --transcode <dir>            %35\n"
+    "      --transcode-output <dir>     %36\n"
+    "      --transcode-preset <name>    %37\n"
+    "      --transcode-format <format>  %38\n"
+    "      --transcode-jobs <n>         %39\n";
 
 const char *CommandlineOptions::kVersionText = "Strawberry %1";
 
@@ -88,7 +96,9 @@ CommandlineOptions::CommandlineOptions(int argc, char* *argv)
       play_track_at_(-1),
       show_osd_(false),
       toggle_pretty_osd_(false),
-      log_levels_(logging::kDefaultLogLevels) {
+      log_levels_(logging::kDefaultLogLevels),
+      transcode_format_("%artist/%album/%track - %title.%extension"),
+      transcode_jobs_(-1) {
 
 #ifdef Q_OS_MACOS
   // Remove -psn_xxx option that Mac passes when opened from Finder.
@@ -144,6 +154,12 @@ bool CommandlineOptions::Parse() {
       {"verbose", no_argument, 0, Verbose},
       {"log-levels", required_argument, 0, LogLevels},
       {"version", no_argument, 0, Version},
+      {"startup-trace", required_argument, 0, StartupTraceFile},
+      {"transcode", required_argument, 0, Transcode},
+      {"transcode-output", required_argument, 0, TranscodeOutput},
+      {"transcode-preset", required_argument, 0, TranscodePreset},
+      {"transcode-format", required_argument, 0, TranscodeFormat},
+      {"transcode-jobs", required_argument, 0, TranscodeJobs},
       {0, 0, 0, 0}};
 
   // Parse the arguments
@@ -185,7 +201,14 @@ bool CommandlineOptions::Parse() {
                      tr("Equivalent to --log-levels *:1"),
                      tr("Equivalent to --log-levels *:3"),
                      tr("Comma separated list of class:level, level is 0-3"))
-                .arg(tr("Print out version information"));
+                .arg(tr("Print out version information"),
+                     tr("Write the time taken by each startup phase to <file> in Chrome trace format"),
+                     tr("Transcoding options"),
+                     tr("Transcode all music files in <dir> without starting the user interface"),
+                     tr("Directory to write the transcoded files to"),
+                     tr("Name of the transcoder preset to use, for example \"Ogg Vorbis\""),
+                     tr("Organise format for the output filenames, relative to the output directory"),
+                     tr("Number of files to transcode in parallel"));
 
         std::cout << translated_help_text.toLocal8Bit().constData();
         return false;
@@ -251,6 +274,9 @@ bool CommandlineOptions::Parse() {
         std::cout << version_text.toLocal8Bit().constData() << std::endl;
         std::exit(0);
       }
+      case StartupTraceFile:
+        startup_trace_file_ = QFile::decodeName(optarg);
+        break;
       case 'v':
         set_volume_ = QString(optarg).toInt(&ok);
         if (!ok) set_volume_ = -1;
@@ -285,6 +311,27 @@ bool CommandlineOptions::Parse() {
         if (!ok) play_track_at_ = -1;
         break;
 
+      case Transcode:
+        transcode_input_ = QFile::decodeName(optarg);
+        break;
+
+      case TranscodeOutput:
+        transcode_output_ = QFile::decodeName(optarg);
+        break;
+
+      case TranscodePreset:
+        transcode_preset_ = QString(optarg);
+        break;
+
+      case TranscodeFormat:
+        transcode_format_ = QString(optarg);
+        break;
+
+      case TranscodeJobs:
+        transcode_jobs_ = QString(optarg).toInt(&ok);
+        if (!ok) transcode_jobs_ = -1;
+        break;
+
       case '?':
       default:
         return false;
@@ -79,6 +79,16 @@ class CommandlineOptions {
   QString language() const { return language_; }
   QString log_levels() const { return log_levels_; }
   QString playlist_name() const { return playlist_name_; }
+  // Only used by the instance being started, not sent to a running instance.
+  QString startup_trace_file() const { return startup_trace_file_; }
+
+  // Headless batch transcoding, these are not sent to a running instance.
+  bool transcode() const { return !transcode_input_.isEmpty(); }
+  QString transcode_input() const { return transcode_input_; }
+  QString transcode_output() const { return transcode_output_; }
+  QString transcode_preset() const { return transcode_preset_; }
+  QString transcode_format() const { return transcode_format_; }
+  int transcode_jobs() const { return transcode_jobs_; }
 
   QByteArray Serialize() const;
   void Load(const QByteArray &serialized);
@@ -97,7 +107,13 @@ class CommandlineOptions {
     Version,
     VolumeIncreaseBy,
     VolumeDecreaseBy,
-    RestartOrPrevious
+    RestartOrPrevious,
+    StartupTraceFile,
+    Transcode,
+    TranscodeOutput,
+    TranscodePreset,
+    TranscodeFormat,
+    TranscodeJobs
   };
 
   QString tr(const char *source_text);
@@ -121,6 +137,13 @@ class CommandlineOptions {
   QString language_;
   QString log_levels_;
   QString playlist_name_;
+  QString startup_trace_file_;
+
+  QString transcode_input_;
+  QString transcode_output_;
+  QString transcode_preset_;
+  QString transcode_format_;
+  int transcode_jobs_;
 
   QList<QUrl> urls_;
 };
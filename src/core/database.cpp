@@ -52,8 +52,9 @@
 #include "scopedtransaction.h"
 
 const char *Database::kDatabaseFilename = "strawberry.db";
-const int Database::kSchemaVersion = 3;
+const int Database::kSchemaVersion = 8;
 const char *Database::kMagicAllSongsTables = "%allsongstables";
+const char *Database::kMagicAllDeviceSongsTables = "%alldevicesongstables";
 
 int Database::sNextConnectionId = 1;
 QMutex Database::sNextConnectionIdMutex;
@@ -530,6 +531,19 @@ void Database::ExecSongTablesCommands(QSqlDatabase &db, const QStringList &song_
           qFatal("Unable to update music collection database");
       }
     }
+    // Only the songs tables of the devices, for columns that playlist items don't have.
+    else if (command.contains(kMagicAllDeviceSongsTables)) {
+      for (const QString &table : song_tables) {
+        if (!table.startsWith("device_")) continue;
+
+        qLog(Info) << "Updating" << table << "for" << kMagicAllDeviceSongsTables;
+        QString new_command(command);
+        new_command.replace(kMagicAllDeviceSongsTables, table);
+        QSqlQuery query(db.exec(new_command));
+        if (CheckErrors(query))
+          qFatal("Unable to update music collection database");
+      }
+    }
     else {
       QSqlQuery query(db.exec(command));
       if (CheckErrors(query)) qFatal("Unable to update music collection database");
@@ -65,6 +65,7 @@ class Database : public QObject {
   static const int kSchemaVersion;
   static const char *kDatabaseFilename;
   static const char *kMagicAllSongsTables;
+  static const char *kMagicAllDeviceSongsTables;
 
   QSqlDatabase Connect();
   bool CheckErrors(const QSqlQuery &query);
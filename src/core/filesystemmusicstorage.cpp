@@ -23,6 +23,19 @@
 
 #include <stdbool.h>
 
+#ifdef Q_OS_LINUX
+#  include <errno.h>
+#  include <string.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/ioctl.h>
+#  include <sys/sendfile.h>
+#  include <sys/stat.h>
+#  include <linux/fs.h>
+#endif
+
+#include <QtGlobal>
+#include <QMutex>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -37,9 +50,26 @@
 
 #include "filesystemmusicstorage.h"
 
+// Copies only touch their own files, so a couple can overlap to hide per file latency.
+const int FilesystemMusicStorage::kMaxConcurrentCopies = 2;
+const qint64 FilesystemMusicStorage::kCopyChunkSize = 8 * 1024 * 1024;
+
 FilesystemMusicStorage::FilesystemMusicStorage(const QString &root)
     : root_(root) {}
 
+bool FilesystemMusicStorage::StartCopy(QList<Song::FileType> *supported_types) {
+
+  Q_UNUSED(supported_types);
+
+  // Only trust what we know about the destination for the duration of one job.
+  QMutexLocker l(&mutex_);
+  created_paths_.clear();
+  copied_covers_.clear();
+
+  return true;
+
+}
+
 bool FilesystemMusicStorage::CopyToStorage(const CopyJob &job) {
 
   const QFileInfo src = QFileInfo(job.source_);
@@ -55,33 +85,50 @@ bool FilesystemMusicStorage::CopyToStorage(const CopyJob &job) {
   // Don't do anything if the destination is the same as the source
   if (src == dest) return true;
 
+  // All songs of an album usually share the same cover, only handle it for the first one.
+  bool copy_cover = false;
+  if (!cover_src.filePath().isEmpty() && !cover_dest.filePath().isEmpty()) {
+    QMutexLocker l(&mutex_);
+    if (!copied_covers_.contains(cover_dest.absoluteFilePath())) {
+      copied_covers_.insert(cover_dest.absoluteFilePath());
+      copy_cover = true;
+    }
+  }
+
   // Create directories as required
-  QDir dir;
-  if (!dir.mkpath(dest.absolutePath())) {
-    qLog(Warning) << "Failed to create directory" << dest.dir().absolutePath();
+  const QString dest_path = dest.absolutePath();
+  if (!MakePath(dest_path)) {
+    qLog(Warning) << "Failed to create directory" << dest_path;
     return false;
   }
 
   // Remove the destination file if it exists and we want to overwrite
   if (job.overwrite_) {
-    if (dest.exists()) QFile::remove(dest.absoluteFilePath());
-    if (!cover_dest.filePath().isEmpty() && cover_dest.exists()) QFile::remove(cover_dest.absoluteFilePath());
+    QFile::remove(dest.absoluteFilePath());
+    if (copy_cover) QFile::remove(cover_dest.absoluteFilePath());
   }
 
   // Copy or move
   bool result(true);
   if (job.remove_original_) {
     result = QFile::rename(src.absoluteFilePath(), dest.absoluteFilePath());
-    if (!cover_src.filePath().isEmpty() && !cover_dest.filePath().isEmpty()) {
+    if (!result && !QDir(dest_path).exists()) {
+      // The directory was removed after we created it.
+      ForgetPath(dest_path);
+      result = MakePath(dest_path) && QFile::rename(src.absoluteFilePath(), dest.absoluteFilePath());
+    }
+    if (copy_cover) {
       QFile::rename(cover_src.absoluteFilePath(), cover_dest.absoluteFilePath());
     }
   }
   else {
-    if (!dest.exists()) {
-      result = QFile::copy(src.absoluteFilePath(), dest.absoluteFilePath());
+    result = CopyFile(src.absoluteFilePath(), dest.absoluteFilePath(), job.progress_);
+    if (!result && !QDir(dest_path).exists()) {
+      ForgetPath(dest_path);
+      result = MakePath(dest_path) && CopyFile(src.absoluteFilePath(), dest.absoluteFilePath(), job.progress_);
     }
-    if (!cover_src.filePath().isEmpty() && !cover_dest.filePath().isEmpty() && !cover_dest.exists()) {
-      QFile::copy(cover_src.absoluteFilePath(), cover_dest.absoluteFilePath());
+    if (copy_cover) {
+      CopyFile(cover_src.absoluteFilePath(), cover_dest.absoluteFilePath(), ProgressFunction());
     }
   }
 
@@ -89,11 +136,138 @@ bool FilesystemMusicStorage::CopyToStorage(const CopyJob &job) {
 
 }
 
+bool FilesystemMusicStorage::MakePath(const QString &path) {
+
+  {
+    QMutexLocker l(&mutex_);
+    if (created_paths_.contains(path)) return true;
+  }
+
+  if (!QDir().mkpath(path)) return false;
+
+  QMutexLocker l(&mutex_);
+  created_paths_.insert(path);
+  return true;
+
+}
+
+void FilesystemMusicStorage::ForgetPath(const QString &path) {
+
+  QMutexLocker l(&mutex_);
+  created_paths_.remove(path);
+
+}
+
+bool FilesystemMusicStorage::CopyFile(const QString &source, const QString &destination, const ProgressFunction &progress) {
+
+#ifdef Q_OS_LINUX
+
+  // Copy inside the kernel instead of streaming the file through userspace buffers.
+  // Existing files are left alone, like QFile::copy() does.
+
+  const int fd_in = open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+  if (fd_in < 0) return false;
+
+  struct stat st;
+  if (fstat(fd_in, &st) != 0) {
+    close(fd_in);
+    return false;
+  }
+
+  const int fd_out = open(QFile::encodeName(destination).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 0777);
+  if (fd_out < 0) {
+    const bool exists = errno == EEXIST;
+    close(fd_in);
+    return exists;
+  }
+
+  bool success = false;
+  bool fallback = false;
+
+#ifdef FICLONE
+  // Filesystems with copy on write, like btrfs and xfs, can share the data blocks with the source.
+  if (ioctl(fd_out, FICLONE, fd_in) == 0) {
+    success = true;
+    if (progress) progress(1.0);
+  }
+#endif
+
+  if (!success) {
+    const qint64 size = st.st_size;
+    qint64 copied = 0;
+#ifdef HAVE_COPY_FILE_RANGE
+    bool use_copy_file_range = true;
+#endif
+    success = true;
+    while (copied < size) {
+      const size_t chunk = qMin(size - copied, kCopyChunkSize);
+      ssize_t ret = -1;
+#ifdef HAVE_COPY_FILE_RANGE
+      if (use_copy_file_range) {
+        ret = copy_file_range(fd_in, nullptr, fd_out, nullptr, chunk, 0);
+        if (ret < 0 && copied == 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+          // Not supported between these filesystems, try sendfile() instead.
+          use_copy_file_range = false;
+          continue;
+        }
+      }
+      else
+#endif
+      {
+        ret = sendfile(fd_out, fd_in, nullptr, chunk);
+        if (ret < 0 && copied == 0 && (errno == ENOSYS || errno == EINVAL)) {
+          fallback = true;
+          success = false;
+          break;
+        }
+      }
+      if (ret < 0) {
+        if (errno == EINTR) continue;
+        qLog(Error) << "Failed to copy" << source << "to" << destination << ":" << strerror(errno);
+        success = false;
+        break;
+      }
+      // The file got shorter while we were copying it.
+      if (ret == 0) break;
+      copied += ret;
+      if (progress) progress(static_cast<float>(copied) / size);
+    }
+    // A truncated copy must not count as success, the source is deleted after a successful move.
+    if (success && copied != size) {
+      qLog(Error) << "Failed to copy" << source << "to" << destination << ": copied" << copied << "of" << size << "bytes";
+      success = false;
+    }
+  }
+
+  close(fd_in);
+  if (close(fd_out) != 0) success = false;
+
+  if (success) return true;
+
+  unlink(QFile::encodeName(destination).constData());
+  if (!fallback) return false;
+
+#endif  // Q_OS_LINUX
+
+  if (QFileInfo::exists(destination)) return true;
+  const bool result = QFile::copy(source, destination);
+  if (result && progress) progress(1.0);
+  return result;
+
+}
+
 bool FilesystemMusicStorage::DeleteFromStorage(const DeleteJob &job) {
 
   QString path = job.metadata_.url().toLocalFile();
   QFileInfo fileInfo(path);
 
+  {
+    // Directories might be removed along with the files in them.
+    QMutexLocker l(&mutex_);
+    created_paths_.clear();
+    copied_covers_.clear();
+  }
+
   if (fileInfo.isDir())
     return Utilities::RemoveRecursive(path);
   else
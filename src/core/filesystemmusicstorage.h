@@ -25,6 +25,11 @@
 #include "config.h"
 
 #include <stdbool.h>
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QSet>
+#include <QList>
 #include <QString>
 
 #include "musicstorage.h"
@@ -35,12 +40,26 @@ public:
   ~FilesystemMusicStorage() {}
 
   QString LocalPath() const { return root_; }
+  int MaxConcurrentCopies() const { return kMaxConcurrentCopies; }
 
+  bool StartCopy(QList<Song::FileType> *supported_types);
   bool CopyToStorage(const CopyJob &job);
   bool DeleteFromStorage(const DeleteJob &job);
 
 private:
+  static const int kMaxConcurrentCopies;
+  static const qint64 kCopyChunkSize;
+
+  bool MakePath(const QString &path);
+  void ForgetPath(const QString &path);
+  static bool CopyFile(const QString &source, const QString &destination, const ProgressFunction &progress);
+
   QString root_;
+
+  // Directories we know exist and covers we've already copied, so each file doesn't have to check them again.
+  QMutex mutex_;
+  QSet<QString> created_paths_;
+  QSet<QString> copied_covers_;
 };
 
 #endif // FILESYSTEMMUSICSTORAGE_H
@@ -71,6 +71,7 @@
 #include "iconloader.h"
 #include "taskmanager.h"
 #include "song.h"
+#include "startuptrace.h"
 #include "stylesheetloader.h"
 #include "systemtrayicon.h"
 #include "windows7thumbbar.h"
@@ -299,7 +300,7 @@ MainWindow::MainWindow(Application *app, SystemTrayIcon *tray_icon, OSD *osd, co
   collection_view_->view()->setModel(collection_sort_model_);
   collection_view_->view()->SetApplication(app_);
 #ifndef Q_OS_WIN
-  device_view_->SetApplication(app_);
+  app_->AddDeferredStartup("Devices", [=]() { InitDevices(); });
 #endif
   playlist_list_->SetApplication(app_);
 
@@ -412,9 +413,6 @@ MainWindow::MainWindow(Application *app, SystemTrayIcon *tray_icon, OSD *osd, co
   ui_->action_add_files_to_transcoder->setDisabled(true);
 #endif
 
-  connect(ui_->action_toggle_scrobbling, SIGNAL(triggered()), app_->scrobbler(), SLOT(ToggleScrobbling()));
-  connect(app_->scrobbler(), SIGNAL(ErrorMessage(QString)), SLOT(ShowErrorDialog(QString)));
-
   // Playlist view actions
   ui_->action_next_playlist->setShortcuts(QList<QKeySequence>() << QKeySequence::fromString("Ctrl+Tab")<< QKeySequence::fromString("Ctrl+PgDown"));
   ui_->action_previous_playlist->setShortcuts(QList<QKeySequence>() << QKeySequence::fromString("Ctrl+Shift+Tab")<< QKeySequence::fromString("Ctrl+PgUp"));
@@ -593,13 +591,10 @@ MainWindow::MainWindow(Application *app, SystemTrayIcon *tray_icon, OSD *osd, co
   connect(ui_->playlist, SIGNAL(UndoRedoActionsChanged(QAction*, QAction*)), SLOT(PlaylistUndoRedoChanged(QAction*, QAction*)));
 
 #if defined(HAVE_GSTREAMER) && !defined(Q_OS_WIN)
-  playlist_copy_to_device_->setDisabled(app_->device_manager()->connected_devices_model()->rowCount() == 0);
-  connect(app_->device_manager()->connected_devices_model(), SIGNAL(IsEmptyChanged(bool)), playlist_copy_to_device_, SLOT(setDisabled(bool)));
+  // Enabled once the devices are set up.
+  playlist_copy_to_device_->setDisabled(true);
 #endif
 
-  connect(app_->scrobbler(), SIGNAL(ScrobblingEnabledChanged(bool)), SLOT(ScrobblingEnabledChanged(bool)));
-  connect(app_->scrobbler(), SIGNAL(ScrobbleButtonVisibilityChanged(bool)), SLOT(ScrobbleButtonVisibilityChanged(bool)));
-
 #ifdef Q_OS_MACOS
   mac::SetApplicationHandler(this);
 #endif
@@ -642,7 +637,6 @@ MainWindow::MainWindow(Application *app, SystemTrayIcon *tray_icon, OSD *osd, co
   connect(global_shortcuts_, SIGNAL(ShowHide()), SLOT(ToggleShowHide()));
   connect(global_shortcuts_, SIGNAL(ShowOSD()), app_->player(), SLOT(ShowOSD()));
   connect(global_shortcuts_, SIGNAL(TogglePrettyOSD()), app_->player(), SLOT(TogglePrettyOSD()));
-  connect(global_shortcuts_, SIGNAL(ToggleScrobbling()), app_->scrobbler(), SLOT(ToggleScrobbling()));
 #endif
 
   // Fancy tabs
@@ -690,7 +684,10 @@ MainWindow::MainWindow(Application *app, SystemTrayIcon *tray_icon, OSD *osd, co
   RefreshStyleSheet();
 
   // Load playlists
-  app_->playlist_manager()->Init(app_->collection_backend(), app_->playlist_backend(), ui_->playlist_sequence, ui_->playlist);
+  {
+    StartupTrace::Phase phase("Playlists");
+    app_->playlist_manager()->Init(app_->collection_backend(), app_->playlist_backend(), ui_->playlist_sequence, ui_->playlist);
+  }
 
   queue_view_->SetPlaylistManager(app_->playlist_manager());
 
@@ -705,8 +702,8 @@ MainWindow::MainWindow(Application *app, SystemTrayIcon *tray_icon, OSD *osd, co
   connect(app_->playlist_manager()->sequence(), SIGNAL(RepeatModeChanged(PlaylistSequence::RepeatMode)), osd_, SLOT(RepeatModeChanged(PlaylistSequence::RepeatMode)));
   connect(app_->playlist_manager()->sequence(), SIGNAL(ShuffleModeChanged(PlaylistSequence::ShuffleMode)), osd_, SLOT(ShuffleModeChanged(PlaylistSequence::ShuffleMode)));
 
-  ScrobbleButtonVisibilityChanged(app_->scrobbler()->ScrobbleButton());
-  ScrobblingEnabledChanged(app_->scrobbler()->IsEnabled());
+  // The scrobbler reads its caches when created, so it is set up after the first frame.
+  app_->AddDeferredStartup("Scrobbler", [=]() { InitScrobbler(); });
 
   // Load settings
   qLog(Debug) << "Loading settings";
@@ -787,6 +784,32 @@ MainWindow::MainWindow(Application *app, SystemTrayIcon *tray_icon, OSD *osd, co
   qLog(Debug) << "Started";
   initialised_ = true;
 
+}
+
+void MainWindow::InitDevices() {
+
+  device_view_->SetApplication(app_);
+
+#if defined(HAVE_GSTREAMER) && !defined(Q_OS_WIN)
+  playlist_copy_to_device_->setDisabled(app_->device_manager()->connected_devices_model()->rowCount() == 0);
+  connect(app_->device_manager()->connected_devices_model(), SIGNAL(IsEmptyChanged(bool)), playlist_copy_to_device_, SLOT(setDisabled(bool)));
+#endif
+
+}
+
+void MainWindow::InitScrobbler() {
+
+  connect(ui_->action_toggle_scrobbling, SIGNAL(triggered()), app_->scrobbler(), SLOT(ToggleScrobbling()));
+  connect(app_->scrobbler(), SIGNAL(ErrorMessage(QString)), SLOT(ShowErrorDialog(QString)));
+  connect(app_->scrobbler(), SIGNAL(ScrobblingEnabledChanged(bool)), SLOT(ScrobblingEnabledChanged(bool)));
+  connect(app_->scrobbler(), SIGNAL(ScrobbleButtonVisibilityChanged(bool)), SLOT(ScrobbleButtonVisibilityChanged(bool)));
+#ifdef HAVE_GLOBALSHORTCUTS
+  connect(global_shortcuts_, SIGNAL(ToggleScrobbling()), app_->scrobbler(), SLOT(ToggleScrobbling()));
+#endif
+
+  ScrobbleButtonVisibilityChanged(app_->scrobbler()->ScrobbleButton());
+  ScrobblingEnabledChanged(app_->scrobbler()->IsEnabled());
+
   app_->scrobbler()->ConnectError();
   if (app_->scrobbler()->IsEnabled() && !app_->scrobbler()->IsOffline()) app_->scrobbler()->Submit();
 
@@ -1613,6 +1636,8 @@ void MainWindow::RenumberTracks() {
     if (first_song.track() > 0) track = first_song.track();
   }
 
+  SongList songs;
+  QList<QPersistentModelIndex> source_indexes;
   for (const QModelIndex &index : indexes) {
     if (index.column() != 0) continue;
 
@@ -1622,21 +1647,31 @@ void MainWindow::RenumberTracks() {
 
     if (song.IsEditable()) {
       song.set_track(track);
-
-      TagReaderReply *reply = TagReaderClient::Instance()->SaveFile(song.url().toLocalFile(), song);
-
-      NewClosure(reply, SIGNAL(Finished(bool)), this, SLOT(SongSaveComplete(TagReaderReply*, QPersistentModelIndex)),reply, QPersistentModelIndex(source_index));
+      songs << song;
+      source_indexes << QPersistentModelIndex(source_index);
     }
     track++;
   }
 
+  if (songs.isEmpty()) return;
+
+  TagReaderReply *reply = TagReaderClient::Instance()->SaveFiles(songs);
+  NewClosure(reply, SIGNAL(Finished(bool)), this, SLOT(SongsSaveComplete(TagReaderReply*, QList<QPersistentModelIndex>)), reply, source_indexes);
+
 }
 
-void MainWindow::SongSaveComplete(TagReaderReply *reply, const QPersistentModelIndex &index) {
-  if (reply->is_successful() && index.isValid()) {
-    app_->playlist_manager()->current()->ReloadItems(QList<int>()<< index.row());
-  }
+void MainWindow::SongsSaveComplete(TagReaderReply *reply, const QList<QPersistentModelIndex> &indexes) {
+
   reply->deleteLater();
+  if (!reply->is_successful()) return;
+
+  const pb::tagreader::SaveFilesResponse &response = reply->message().save_files_response();
+  QList<int> rows;
+  for (int i = 0; i < indexes.count() && i < response.success_size(); ++i) {
+    if (response.success(i) && indexes[i].isValid()) rows << indexes[i].row();
+  }
+  if (!rows.isEmpty()) app_->playlist_manager()->current()->ReloadItems(rows);
+
 }
 
 void MainWindow::SelectionSetValue() {
@@ -1646,6 +1681,8 @@ void MainWindow::SelectionSetValue() {
 
   QModelIndexList indexes =ui_->playlist->view()->selectionModel()->selection().indexes();
 
+  SongList songs;
+  QList<QPersistentModelIndex> source_indexes;
   for (const QModelIndex &index : indexes) {
     if (index.column() != 0) continue;
 
@@ -1654,12 +1691,16 @@ void MainWindow::SelectionSetValue() {
     Song song = app_->playlist_manager()->current()->item_at(row)->Metadata();
 
     if (Playlist::set_column_value(song, column, column_value)) {
-      TagReaderReply *reply = TagReaderClient::Instance()->SaveFile(song.url().toLocalFile(), song);
-
-      NewClosure(reply, SIGNAL(Finished(bool)), this, SLOT(SongSaveComplete(TagReaderReply*, QPersistentModelIndex)), reply, QPersistentModelIndex(source_index));
+      songs << song;
+      source_indexes << QPersistentModelIndex(source_index);
     }
   }
 
+  if (songs.isEmpty()) return;
+
+  TagReaderReply *reply = TagReaderClient::Instance()->SaveFiles(songs);
+  NewClosure(reply, SIGNAL(Finished(bool)), this, SLOT(SongsSaveComplete(TagReaderReply*, QList<QPersistentModelIndex>)), reply, source_indexes);
+
 }
 
 void MainWindow::EditValue() {
@@ -2222,7 +2263,7 @@ void MainWindow::AutoCompleteTags() {
 
   // Create the tag fetching stuff if it hasn't been already
   if (!tag_fetcher_) {
-    tag_fetcher_.reset(new TagFetcher);
+    tag_fetcher_.reset(new TagFetcher(app_));
     track_selection_dialog_.reset(new TrackSelectionDialog);
     track_selection_dialog_->set_save_on_close(true);
 
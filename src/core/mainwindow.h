@@ -214,7 +214,7 @@ signals:
 
   void PlayingWidgetPositionChanged(bool above_status_bar);
 
-  void SongSaveComplete(TagReaderReply *reply, const QPersistentModelIndex& index);
+  void SongsSaveComplete(TagReaderReply *reply, const QList<QPersistentModelIndex> &indexes);
 
   void ShowCoverManager();
 
@@ -263,6 +263,10 @@ signals:
 
   void CheckFullRescanRevisions();
 
+  // Parts of the window set up from the deferred startup stages, after the first frame.
+  void InitDevices();
+  void InitScrobbler();
+
   // creates the icon by painting the full one depending on the current position
   QPixmap CreateOverlayedIcon(int position, int scrobble_point);
 
@@ -68,6 +68,7 @@ void RegisterMetaTypes() {
   qRegisterMetaType<const char*>("const char*");
   qRegisterMetaType<QList<int>>("QList<int>");
   qRegisterMetaType<QList<QUrl>>("QList<QUrl>");
+  qRegisterMetaType<QMap<QString, QByteArray>>("QMap<QString,QByteArray>");
   qRegisterMetaType<QFileInfo>("QFileInfo");
   qRegisterMetaType<QAbstractSocket::SocketState>();
   qRegisterMetaType<QAbstractSocket::SocketState>("QAbstractSocket::SocketState");
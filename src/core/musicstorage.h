@@ -77,6 +77,9 @@ class MusicStorage {
   virtual Song::FileType GetTranscodeFormat() const { return Song::FileType_Unknown; }
   virtual bool GetSupportedFiletypes(QList<Song::FileType>* ret) { return true; }
 
+  // How many CopyToStorage() calls may run at the same time from different threads.
+  virtual int MaxConcurrentCopies() const { return 1; }
+
   virtual bool StartCopy(QList<Song::FileType>* supported_types) { return true;}
   virtual bool CopyToStorage(const CopyJob& job) = 0;
   virtual void FinishCopy(bool success) {}
@@ -22,6 +22,7 @@
 
 #include <stdbool.h>
 #include <QSqlDatabase>
+#include <QSqlError>
 
 #include "core/logging.h"
 #include "scopedtransaction.h"
@@ -38,13 +39,18 @@ ScopedTransaction::~ScopedTransaction() {
   }
 }
 
-void ScopedTransaction::Commit() {
+bool ScopedTransaction::Commit() {
   if (!pending_) {
     qLog(Warning) << "Tried to commit a ScopedTransaction twice";
-    return;
+    return false;
   }
 
-  db_->commit();
   pending_ = false;
+  if (!db_->commit()) {
+    qLog(Error) << "Failed to commit transaction:" << db_->lastError();
+    db_->rollback();
+    return false;
+  }
+  return true;
 }
 
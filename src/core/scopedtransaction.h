@@ -35,7 +35,8 @@ class ScopedTransaction : boost::noncopyable {
   ScopedTransaction(QSqlDatabase *db);
   ~ScopedTransaction();
 
-  void Commit();
+  // Returns false if the transaction couldn't be committed.
+  bool Commit();
 
  private:
   QSqlDatabase *db_;
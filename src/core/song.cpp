@@ -35,6 +35,8 @@
 #include <QtAlgorithms>
 #include <QHash>
 #include <QByteArray>
+#include <QCryptographicHash>
+#include <QtEndian>
 #include <QVariant>
 #include <QString>
 #include <QStringList>
@@ -378,6 +380,26 @@ void Song::set_cue_path(const QString &v) { d->cue_path_ = v; }
 
 void Song::set_image(const QImage &i) { d->image_ = i; }
 
+QVariant Song::DuplicateKey(const QString &artist, const QString &album, const QString &title) {
+
+  // Songs are duplicates when these match ignoring case and whitespace, untagged songs are never duplicates.
+  const QString normalized_artist = artist.simplified().toCaseFolded();
+  const QString normalized_album = album.simplified().toCaseFolded();
+  const QString normalized_title = title.simplified().toCaseFolded();
+  if (normalized_artist.isEmpty() || normalized_album.isEmpty() || normalized_title.isEmpty()) return QVariant(QVariant::LongLong);
+
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  hash.addData(normalized_artist.toUtf8());
+  hash.addData(QByteArray(1, '\0'));
+  hash.addData(normalized_album.toUtf8());
+  hash.addData(QByteArray(1, '\0'));
+  hash.addData(normalized_title.toUtf8());
+
+  const QByteArray result = hash.result();
+  return qFromBigEndian<qint64>(reinterpret_cast<const uchar*>(result.constData()));
+
+}
+
 QString Song::JoinSpec(const QString &table) {
   return Utilities::Prepend(table + ".", kColumns).join(", ");
 }
@@ -126,6 +126,9 @@ class Song {
 
   static QString JoinSpec(const QString &table);
 
+  // Key that is equal for songs with the same artist, album and title, or a null value for untagged songs.
+  static QVariant DuplicateKey(const QString &artist, const QString &album, const QString &title);
+
   static Source SourceFromURL(const QUrl &url);
   static QString TextForSource(Source source);
   static QIcon IconForSource(Source source);
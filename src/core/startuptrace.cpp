@@ -0,0 +1,115 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QFile>
+#include <QIODevice>
+#include <QString>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "core/logging.h"
+
+#include "startuptrace.h"
+
+namespace {
+
+QMutex sMutex;
+QString sFilename;
+QElapsedTimer sTimer;
+QJsonArray sEvents;
+
+}  // namespace
+
+void StartupTrace::Enable(const QString &filename) {
+
+  QMutexLocker l(&sMutex);
+  sFilename = filename;
+  sTimer.start();
+
+}
+
+bool StartupTrace::IsEnabled() {
+
+  QMutexLocker l(&sMutex);
+  return !sFilename.isEmpty();
+
+}
+
+qint64 StartupTrace::ElapsedUsec() {
+
+  QMutexLocker l(&sMutex);
+  return sTimer.isValid() ? sTimer.nsecsElapsed() / 1000 : 0;
+
+}
+
+void StartupTrace::AddPhase(const QString &name, const qint64 start_usec, const qint64 duration_usec) {
+
+  QMutexLocker l(&sMutex);
+  if (sFilename.isEmpty()) return;
+
+  // Complete events, see the Trace Event Format documentation.
+  QJsonObject event;
+  event.insert("name", name);
+  event.insert("cat", "startup");
+  event.insert("ph", "X");
+  event.insert("ts", start_usec);
+  event.insert("dur", duration_usec);
+  event.insert("pid", QCoreApplication::applicationPid());
+  event.insert("tid", 1);
+  sEvents.append(event);
+
+}
+
+void StartupTrace::Write() {
+
+  QMutexLocker l(&sMutex);
+  if (sFilename.isEmpty()) return;
+
+  QJsonObject object;
+  object.insert("traceEvents", sEvents);
+  object.insert("displayTimeUnit", "ms");
+
+  QFile file(sFilename);
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(QJsonDocument(object).toJson());
+    file.close();
+    qLog(Info) << "Wrote startup trace to" << sFilename;
+  }
+  else {
+    qLog(Error) << "Unable to write startup trace to" << sFilename;
+  }
+
+  sFilename.clear();
+  sEvents = QJsonArray();
+
+}
+
+StartupTrace::Phase::Phase(const QString &name) : name_(name), start_usec_(StartupTrace::ElapsedUsec()) {}
+
+StartupTrace::Phase::~Phase() {
+  StartupTrace::AddPhase(name_, start_usec_, StartupTrace::ElapsedUsec() - start_usec_);
+}
@@ -0,0 +1,57 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QString>
+
+// Records how long each phase of startup takes and writes them out in Chrome trace format, so they can be loaded in chrome://tracing.
+// Nothing is recorded unless Enable() was called, which is done for the --startup-trace commandline option.
+
+class StartupTrace {
+ public:
+  static void Enable(const QString &filename);
+  static bool IsEnabled();
+
+  static qint64 ElapsedUsec();
+  static void AddPhase(const QString &name, const qint64 start_usec, const qint64 duration_usec);
+
+  // Writes the report and stops recording.
+  static void Write();
+
+  // Records the time from construction until it goes out of scope as one phase.
+  class Phase {
+   public:
+    explicit Phase(const QString &name);
+    ~Phase();
+
+   private:
+    Q_DISABLE_COPY(Phase)
+
+    QString name_;
+    qint64 start_usec_;
+  };
+};
+
+#endif  // STARTUPTRACE_H
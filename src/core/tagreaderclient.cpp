@@ -39,7 +39,7 @@
 const char *TagReaderClient::kWorkerExecutableName = "strawberry-tagreader";
 TagReaderClient *TagReaderClient::sInstance = nullptr;
 
-TagReaderClient::TagReaderClient(QObject *parent) : QObject(parent), worker_pool_(new WorkerPool<HandlerType>(this)) {
+TagReaderClient::TagReaderClient(QObject *parent) : QObject(parent), worker_pool_(new WorkerPool<HandlerType>(this)), started_(0) {
 
   sInstance = this;
 
@@ -48,20 +48,34 @@ TagReaderClient::TagReaderClient(QObject *parent) : QObject(parent), worker_pool
   connect(worker_pool_, SIGNAL(WorkerFailedToStart()), SLOT(WorkerFailedToStart()));
 }
 
-void TagReaderClient::Start() { worker_pool_->Start(); }
+void TagReaderClient::Start() {
+
+  if (!started_.testAndSetOrdered(0, 1)) return;
+  worker_pool_->Start();
+
+}
+
+TagReaderReply *TagReaderClient::SendMessageWithReply(pb::tagreader::Message *message) {
+
+  // Requests made before the deferred startup would otherwise wait for workers that aren't started yet.
+  Start();
+  return worker_pool_->SendMessageWithReply(message);
+
+}
 
 void TagReaderClient::WorkerFailedToStart() {
   qLog(Error) << "The" << kWorkerExecutableName << "executable was not found in the current directory or on the PATH.  Strawberry will not be able to read music file tags without it.";
 }
 
-TagReaderReply *TagReaderClient::ReadFile(const QString &filename) {
+TagReaderReply *TagReaderClient::ReadFile(const QString &filename, const int thumbnail_size) {
 
   pb::tagreader::Message message;
   pb::tagreader::ReadFileRequest *req = message.mutable_read_file_request();
 
   req->set_filename(DataCommaSizeFromQString(filename));
+  if (thumbnail_size > 0) req->set_thumbnail_size(thumbnail_size);
 
-  return worker_pool_->SendMessageWithReply(&message);
+  return SendMessageWithReply(&message);
 
 }
 
@@ -73,12 +87,27 @@ TagReaderReply *TagReaderClient::SaveFile(const QString &filename, const Song &m
   req->set_filename(DataCommaSizeFromQString(filename));
   metadata.ToProtobuf(req->mutable_metadata());
 
-  ReplyType *reply = worker_pool_->SendMessageWithReply(&message);
+  ReplyType *reply = SendMessageWithReply(&message);
 
   return reply;
 
 }
 
+TagReaderReply *TagReaderClient::SaveFiles(const SongList &songs) {
+
+  pb::tagreader::Message message;
+  pb::tagreader::SaveFilesRequest *req = message.mutable_save_files_request();
+
+  for (const Song &song : songs) {
+    pb::tagreader::SaveFileRequest *file = req->add_files();
+    file->set_filename(DataCommaSizeFromQString(song.url().toLocalFile()));
+    song.ToProtobuf(file->mutable_metadata());
+  }
+
+  return SendMessageWithReply(&message);
+
+}
+
 TagReaderReply *TagReaderClient::IsMediaFile(const QString &filename) {
 
   pb::tagreader::Message message;
@@ -86,7 +115,7 @@ TagReaderReply *TagReaderClient::IsMediaFile(const QString &filename) {
 
   req->set_filename(DataCommaSizeFromQString(filename));
 
-  return worker_pool_->SendMessageWithReply(&message);
+  return SendMessageWithReply(&message);
 
 }
 
@@ -97,17 +126,19 @@ TagReaderReply *TagReaderClient::LoadEmbeddedArt(const QString &filename) {
 
   req->set_filename(DataCommaSizeFromQString(filename));
 
-  return worker_pool_->SendMessageWithReply(&message);
+  return SendMessageWithReply(&message);
 
 }
 
-void TagReaderClient::ReadFileBlocking(const QString &filename, Song *song) {
+void TagReaderClient::ReadFileBlocking(const QString &filename, Song *song, const int thumbnail_size, QByteArray *thumbnail) {
 
   Q_ASSERT(QThread::currentThread() != thread());
 
-  TagReaderReply *reply = ReadFile(filename);
+  TagReaderReply *reply = ReadFile(filename, thumbnail ? thumbnail_size : 0);
   if (reply->WaitForFinished()) {
-    song->InitFromProtobuf(reply->message().read_file_response().metadata());
+    const pb::tagreader::ReadFileResponse &response = reply->message().read_file_response();
+    song->InitFromProtobuf(response.metadata());
+    if (thumbnail) *thumbnail = QByteArray(response.thumbnail().data(), response.thumbnail().size());
   }
   reply->deleteLater();
 
@@ -153,8 +184,9 @@ QImage TagReaderClient::LoadEmbeddedArtBlocking(const QString &filename) {
 
   TagReaderReply *reply = LoadEmbeddedArt(filename);
   if (reply->WaitForFinished()) {
+    // Decode straight from the reply, the art can be several megabytes.
     const std::string &data_str = reply->message().load_embedded_art_response().data();
-    ret.loadFromData(QByteArray(data_str.data(), data_str.size()));
+    ret.loadFromData(QByteArray::fromRawData(data_str.data(), data_str.size()));
   }
   reply->deleteLater();
 
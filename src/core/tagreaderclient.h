@@ -26,8 +26,10 @@
 #include <stdbool.h>
 
 #include <QObject>
+#include <QAtomicInt>
 #include <QList>
 #include <QString>
+#include <QByteArray>
 #include <QImage>
 
 #include "core/messagehandler.h"
@@ -50,16 +52,20 @@ class TagReaderClient : public QObject {
 
   static const char *kWorkerExecutableName;
 
+  // Starts the worker processes, this is also done by the first request. Can be called more than once.
   void Start();
 
-  ReplyType *ReadFile(const QString &filename);
+  ReplyType *ReadFile(const QString &filename, const int thumbnail_size = 0);
   ReplyType *SaveFile(const QString &filename, const Song &metadata);
+  // Saves the tags of all songs with one request, the response has a result for each song.
+  // Each song carries its full metadata, so the songs don't need to share the changed fields.
+  ReplyType *SaveFiles(const SongList &songs);
   ReplyType *IsMediaFile(const QString &filename);
   ReplyType *LoadEmbeddedArt(const QString &filename);
 
   // Convenience functions that call the above functions and wait for a response.
   // These block the calling thread with a semaphore, and must NOT be called from the TagReaderClient's thread.
-  void ReadFileBlocking(const QString &filename, Song *song);
+  void ReadFileBlocking(const QString &filename, Song *song, const int thumbnail_size = 0, QByteArray *thumbnail = nullptr);
   bool SaveFileBlocking(const QString &filename, const Song &metadata);
   bool IsMediaFileBlocking(const QString &filename);
   QImage LoadEmbeddedArtBlocking(const QString &filename);
@@ -71,9 +77,12 @@ class TagReaderClient : public QObject {
   void WorkerFailedToStart();
 
  private:
+  ReplyType *SendMessageWithReply(pb::tagreader::Message *message);
+
   static TagReaderClient *sInstance;
 
   WorkerPool<HandlerType> *worker_pool_;
+  QAtomicInt started_;
   QList<pb::tagreader::Message> message_queue_;
 };
 
@@ -76,6 +76,18 @@ void TaskManager::SetTaskBlocksCollectionScans(int id) {
 
 }
 
+void TaskManager::SetTaskName(int id, const QString &name) {
+
+  {
+    QMutexLocker l(&mutex_);
+    if (!tasks_.contains(id)) return;
+
+    tasks_[id].name = name;
+  }
+
+  emit TasksChanged();
+}
+
 void TaskManager::SetTaskProgress(int id, int progress, int max) {
 
   {
@@ -64,6 +64,7 @@ class TaskManager : public QObject {
 
   int StartTask(const QString &name);
   void SetTaskBlocksCollectionScans(int id);
+  void SetTaskName(int id, const QString &name);
   void SetTaskProgress(int id, int progress, int max = 0);
   void IncreaseTaskProgress(int id, int progress, int max = 0);
   void SetTaskFinished(int id);
@@ -32,8 +32,12 @@
 #include "core/song.h"
 #include "albumcoverfetcher.h"
 #include "albumcoverfetchersearch.h"
+#include "albumcovermisscache.h"
+#include "coverproviders.h"
+#include "coversearchstatistics.h"
 
-const int AlbumCoverFetcher::kMaxConcurrentRequests = 5;
+// Each provider limits its own concurrent searches, this only bounds how many searches are in flight.
+const int AlbumCoverFetcher::kMaxConcurrentRequests = 10;
 
 AlbumCoverFetcher::AlbumCoverFetcher(CoverProviders *cover_providers, QObject *parent, QNetworkAccessManager *network)
     : QObject(parent),
@@ -45,7 +49,7 @@ AlbumCoverFetcher::AlbumCoverFetcher(CoverProviders *cover_providers, QObject *p
   connect(request_starter_, SIGNAL(timeout()), SLOT(StartRequests()));
 }
 
-quint64 AlbumCoverFetcher::FetchAlbumCover(const QString &artist, const QString &album, bool fetchall) {
+quint64 AlbumCoverFetcher::FetchAlbumCover(const QString &artist, const QString &album, bool fetchall, bool batch) {
 
   CoverSearchRequest request;
   request.artist = artist;
@@ -55,6 +59,7 @@ quint64 AlbumCoverFetcher::FetchAlbumCover(const QString &artist, const QString
   request.search = false;
   request.id = next_id_++;
   request.fetchall = fetchall;
+  request.batch = batch;
 
   AddRequest(request);
   return request.id;
@@ -71,6 +76,7 @@ quint64 AlbumCoverFetcher::SearchForCovers(const QString &artist, const QString
   request.search = true;
   request.id = next_id_++;
   request.fetchall = false;
+  request.batch = false;
 
   AddRequest(request);
   return request.id;
@@ -79,6 +85,20 @@ quint64 AlbumCoverFetcher::SearchForCovers(const QString &artist, const QString
 
 void AlbumCoverFetcher::AddRequest(const CoverSearchRequest &req) {
 
+  // Don't search for albums that had no cover the last time around when fetching all missing covers.
+  if (req.batch && !req.search && cover_providers_->miss_cache()->Contains(req.artist, req.album)) {
+    QMetaObject::invokeMethod(this, "KnownMissFetched", Qt::QueuedConnection, Q_ARG(quint64, req.id));
+    return;
+  }
+
+  const QString key = RequestKey(req);
+  if (request_keys_.contains(key)) {
+    coalesced_requests_.insert(request_keys_[key], req.id);
+    return;
+  }
+  request_keys_.insert(key, req.id);
+  requests_.insert(req.id, req);
+
   queued_requests_.enqueue(req);
 
   if (!request_starter_->isActive()) request_starter_->start();
@@ -87,9 +107,29 @@ void AlbumCoverFetcher::AddRequest(const CoverSearchRequest &req) {
 
 }
 
+QString AlbumCoverFetcher::RequestKey(const CoverSearchRequest &req) {
+  return QString("%1:%2:%3\n%4").arg(req.search ? "search" : "fetch", req.fetchall ? "all" : "single", req.artist.toLower(), req.album.toLower());
+}
+
+QList<quint64> AlbumCoverFetcher::TakeCoalescedRequests(quint64 request_id) {
+
+  QList<quint64> ids = coalesced_requests_.values(request_id);
+  coalesced_requests_.remove(request_id);
+
+  if (requests_.contains(request_id)) {
+    request_keys_.remove(RequestKey(requests_[request_id]));
+  }
+
+  return ids;
+
+}
+
 void AlbumCoverFetcher::Clear() {
 
   queued_requests_.clear();
+  request_keys_.clear();
+  coalesced_requests_.clear();
+  requests_.clear();
 
   for (AlbumCoverFetcherSearch *search : active_requests_.values()) {
     search->Cancel();
@@ -122,14 +162,36 @@ void AlbumCoverFetcher::StartRequests() {
 
 }
 
+static CoverSearchStatistics CoalescedStatistics(const CoverSearchStatistics &statistics) {
+
+  // Requests that shared a search count towards the found and missing images, but didn't cost any network requests.
+  CoverSearchStatistics ret;
+  ret.chosen_images_by_provider_ = statistics.chosen_images_by_provider_;
+  ret.chosen_images_ = statistics.chosen_images_;
+  ret.missing_images_ = statistics.missing_images_;
+  ret.chosen_width_ = statistics.chosen_width_;
+  ret.chosen_height_ = statistics.chosen_height_;
+  return ret;
+
+}
+
 void AlbumCoverFetcher::SingleSearchFinished(quint64 request_id, CoverSearchResults results) {
 
   AlbumCoverFetcherSearch *search = active_requests_.take(request_id);
   if (!search) return;
 
+  const QList<quint64> coalesced_ids = TakeCoalescedRequests(request_id);
+  requests_.remove(request_id);
+
   search->deleteLater();
   emit SearchFinished(request_id, results, search->statistics());
 
+  for (quint64 id : coalesced_ids) {
+    emit SearchFinished(id, results, CoalescedStatistics(search->statistics()));
+  }
+
+  StartRequests();
+
 }
 
 void AlbumCoverFetcher::SingleCoverFetched(quint64 request_id, const QImage &image) {
@@ -137,8 +199,31 @@ void AlbumCoverFetcher::SingleCoverFetched(quint64 request_id, const QImage &ima
   AlbumCoverFetcherSearch *search = active_requests_.take(request_id);
   if (!search) return;
 
+  const QList<quint64> coalesced_ids = TakeCoalescedRequests(request_id);
+  const CoverSearchRequest request = requests_.take(request_id);
+
+  if (!image.isNull()) {
+    cover_providers_->miss_cache()->Remove(request.artist, request.album);
+  }
+  else if (request.batch && !search->timed_out()) {
+    cover_providers_->miss_cache()->Add(request.artist, request.album);
+  }
+
   search->deleteLater();
   emit AlbumCoverFetched(request_id, image, search->statistics());
 
+  for (quint64 id : coalesced_ids) {
+    emit AlbumCoverFetched(id, image, CoalescedStatistics(search->statistics()));
+  }
+
+  StartRequests();
+
 }
 
+void AlbumCoverFetcher::KnownMissFetched(quint64 request_id) {
+
+  CoverSearchStatistics statistics;
+  statistics.missing_images_++;
+  emit AlbumCoverFetched(request_id, QImage(), statistics);
+
+}
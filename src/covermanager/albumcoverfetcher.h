@@ -57,6 +57,9 @@ struct CoverSearchRequest {
 
   // Is the request part of fetchall (fetching all missing covers)
   bool fetchall;
+
+  // Is the request part of a batch started by the user, only those use and update the miss cache
+  bool batch;
 };
 
 // This structure represents a single result of some album's cover search request.
@@ -88,7 +91,7 @@ class AlbumCoverFetcher : public QObject {
   static const int kMaxConcurrentRequests;
 
   quint64 SearchForCovers(const QString &artist, const QString &album);
-  quint64 FetchAlbumCover(const QString &artist, const QString &album, bool fetchall);
+  quint64 FetchAlbumCover(const QString &artist, const QString &album, bool fetchall, bool batch = false);
 
   void Clear();
 
@@ -100,9 +103,12 @@ signals:
   void SingleSearchFinished(quint64, CoverSearchResults results);
   void SingleCoverFetched(quint64, const QImage &cover);
   void StartRequests();
+  void KnownMissFetched(quint64 request_id);
 
  private:
   void AddRequest(const CoverSearchRequest &req);
+  static QString RequestKey(const CoverSearchRequest &req);
+  QList<quint64> TakeCoalescedRequests(quint64 request_id);
 
   CoverProviders *cover_providers_;
   QNetworkAccessManager *network_;
@@ -111,6 +117,11 @@ signals:
   QQueue<CoverSearchRequest> queued_requests_;
   QHash<quint64, AlbumCoverFetcherSearch*> active_requests_;
 
+  // Identical requests queued while one is queued or active get the result of the first one instead of a search of their own.
+  QHash<QString, quint64> request_keys_;
+  QMultiHash<quint64, quint64> coalesced_requests_;
+  QHash<quint64, CoverSearchRequest> requests_;
+
   QTimer *request_starter_;
 
 };
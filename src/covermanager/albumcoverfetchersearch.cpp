@@ -56,7 +56,8 @@ AlbumCoverFetcherSearch::AlbumCoverFetcherSearch(
       request_(request),
       image_load_timeout_(new NetworkTimeouts(kImageLoadTimeoutMs, this)),
       network_(network),
-      cancel_requested_(false) {
+      cancel_requested_(false),
+      timed_out_(false) {
 
   // We will terminate the search after kSearchTimeoutMs miliseconds if we are not able to find all of the results before that point in time
   QTimer::singleShot(kSearchTimeoutMs, this, SLOT(TerminateSearch()));
@@ -65,8 +66,10 @@ AlbumCoverFetcherSearch::AlbumCoverFetcherSearch(
 
 void AlbumCoverFetcherSearch::TerminateSearch() {
 
+  if (!pending_requests_.isEmpty() && !cancel_requested_) timed_out_ = true;
+
   for (int id : pending_requests_.keys()) {
-    pending_requests_.take(id)->CancelSearch(id);
+    pending_requests_.take(id)->CancelQueuedSearch(id, timed_out_);
   }
 
   AllProvidersFinished();
@@ -85,7 +88,7 @@ void AlbumCoverFetcherSearch::Start(CoverProviders *cover_providers) {
 
     connect(provider, SIGNAL(SearchFinished(int, QList<CoverSearchResult>)), SLOT(ProviderSearchFinished(int, QList<CoverSearchResult>)));
     const int id = cover_providers->NextId();
-    const bool success = provider->StartSearch(request_.artist, request_.album, id);
+    const bool success = provider->QueueSearch(request_.artist, request_.album, id);
 
     if (success) {
       pending_requests_[id] = provider;
@@ -58,6 +58,9 @@ class AlbumCoverFetcherSearch : public QObject {
 
   CoverSearchStatistics statistics() const { return statistics_; }
 
+  // True if the search was terminated before all providers answered, so an empty result doesn't mean there is no cover.
+  bool timed_out() const { return timed_out_; }
+
  signals:
   // It's the end of search (when there was no fetch-me-a-cover request).
   void SearchFinished(quint64, const CoverSearchResults &results);
@@ -102,6 +105,7 @@ class AlbumCoverFetcherSearch : public QObject {
   QNetworkAccessManager *network_;
 
   bool cancel_requested_;
+  bool timed_out_;
 
 };
 
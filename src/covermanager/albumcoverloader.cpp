@@ -24,7 +24,12 @@
 #include <QObject>
 #include <QQueue>
 #include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 #include <QStandardPaths>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QSize>
 #include <QList>
 #include <QSet>
@@ -33,6 +38,7 @@
 #include <QStringBuilder>
 #include <QUrl>
 #include <QImage>
+#include <QImageReader>
 #include <QPixmap>
 #include <QPainter>
 #include <QNetworkReply>
@@ -42,19 +48,54 @@
 #include "core/network.h"
 #include "core/song.h"
 #include "core/tagreaderclient.h"
+#include "collection/collectionbackend.h"
 #include "albumcoverloader.h"
 #include "albumcoverloaderoptions.h"
+#include "albumcoverthumbnailcache.h"
+
+const int AlbumCoverLoader::kMaxWorkers = 4;
+const int AlbumCoverLoader::kMaxCacheSize = 65536;  // ~64MB, the cost is in kilobytes.
 
 AlbumCoverLoader::AlbumCoverLoader(QObject *parent)
     : QObject(parent),
-      stop_requested_(false),
+      stop_requested_(0),
       next_id_(1),
-      network_(new NetworkAccessManager(this)){}
+      running_workers_(0),
+      thread_pool_(new QThreadPool(this)),
+      network_(new NetworkAccessManager(this)),
+      cache_(kMaxCacheSize),
+      thumbnail_cache_(new AlbumCoverThumbnailCache(ThumbnailCacheDir())),
+      collection_backend_(nullptr) {
+
+  thread_pool_->setMaxThreadCount(qBound(1, QThread::idealThreadCount(), kMaxWorkers));
+  // Each worker thread gets its own database connection for the art thumbnails, keep the threads so they are reused.
+  thread_pool_->setExpiryTimeout(-1);
+
+}
+
+AlbumCoverLoader::~AlbumCoverLoader() {
+
+  stop_requested_.storeRelease(1);
+  thread_pool_->waitForDone();
+  delete thumbnail_cache_;
+
+}
+
+void AlbumCoverLoader::SetCollectionBackend(CollectionBackend *collection_backend) {
+
+  QMutexLocker l(&mutex_);
+  collection_backend_ = collection_backend;
+
+}
 
 QString AlbumCoverLoader::ImageCacheDir() {
   return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/albumcovers";
 }
 
+QString AlbumCoverLoader::ThumbnailCacheDir() {
+  return ImageCacheDir() + "/thumbnails";
+}
+
 void AlbumCoverLoader::CancelTask(quint64 id) {
 
   QMutexLocker l(&mutex_);
@@ -79,6 +120,24 @@ void AlbumCoverLoader::CancelTasks(const QSet<quint64> &ids) {
   }
 }
 
+void AlbumCoverLoader::PrioritizeTasks(const QSet<quint64> &ids) {
+
+  QMutexLocker l(&mutex_);
+  QQueue<Task> prioritized;
+  for (QQueue<Task>::iterator it = tasks_.begin(); it != tasks_.end();) {
+    if (ids.contains(it->id)) {
+      prioritized << *it;
+      it = tasks_.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+  prioritized.append(tasks_);
+  tasks_.swap(prioritized);
+
+}
+
 quint64 AlbumCoverLoader::LoadImageAsync(const AlbumCoverLoaderOptions& options, const Song &song) {
   return LoadImageAsync(options, song.art_automatic(), song.art_manual(), song.url().toLocalFile(), song.image());
 }
@@ -106,17 +165,32 @@ quint64 AlbumCoverLoader::LoadImageAsync(const AlbumCoverLoaderOptions &options,
 
 void AlbumCoverLoader::ProcessTasks() {
 
-  while (!stop_requested_) {
+  // Decoding and scaling is done by a bounded number of workers in the thread pool, each taking tasks from the front of the queue until it's empty.
+  QMutexLocker l(&mutex_);
+  while (!stop_requested_.loadAcquire() && running_workers_ < thread_pool_->maxThreadCount() && running_workers_ < tasks_.count()) {
+    ++running_workers_;
+    QtConcurrent::run(thread_pool_, this, &AlbumCoverLoader::ProcessTasksWorker);
+  }
+
+}
+
+void AlbumCoverLoader::ProcessTasksWorker() {
+
+  forever {
     // Get the next task
     Task task;
     {
       QMutexLocker l(&mutex_);
-      if (tasks_.isEmpty()) return;
+      if (stop_requested_.loadAcquire() || tasks_.isEmpty()) {
+        --running_workers_;
+        return;
+      }
       task = tasks_.dequeue();
     }
 
     ProcessTask(&task);
   }
+
 }
 
 void AlbumCoverLoader::ProcessTask(Task *task) {
@@ -128,7 +202,13 @@ void AlbumCoverLoader::ProcessTask(Task *task) {
   }
 
   if (result.loaded_success) {
+    if (result.from_cache) {
+      emit ImageLoaded(task->id, result.image);
+      emit ImageLoaded(task->id, result.image, result.image);
+      return;
+    }
     QImage scaled = ScaleAndPad(task->options, result.image);
+    InsertIntoCache(result.cache_key, scaled);
     emit ImageLoaded(task->id, scaled);
     emit ImageLoaded(task->id, scaled, result.image);
     return;
@@ -156,7 +236,7 @@ AlbumCoverLoader::TryLoadResult AlbumCoverLoader::TryLoadImage(const Task &task)
 
   // An image embedded in the song itself takes priority
   if (!task.embedded_image.isNull())
-    return TryLoadResult(false, true, ScaleAndPad(task.options, task.embedded_image));
+    return TryLoadResult(false, true, task.embedded_image);
 
   QString filename;
   switch (task.state) {
@@ -168,19 +248,38 @@ AlbumCoverLoader::TryLoadResult AlbumCoverLoader::TryLoadImage(const Task &task)
     return TryLoadResult(false, true, task.options.default_output_image_);
 
   if (filename == Song::kEmbeddedCover && !task.song_filename.isEmpty()) {
+    const QString cache_key = CacheKey(task.options, task.song_filename, "embedded");
+    QImage cached_image;
+    if (LoadFromCache(cache_key, &cached_image)) return TryLoadResult(false, true, cached_image, cache_key, true);
+
+    // Small covers of collection songs come from the thumbnail stored when the file was scanned, without opening the file.
+    if (task.options.scale_output_image_ && !task.options.keep_original_image_ && task.options.desired_height_ <= CollectionBackend::kArtThumbnailSize) {
+      CollectionBackend *collection_backend = nullptr;
+      {
+        QMutexLocker l(&mutex_);
+        collection_backend = collection_backend_;
+      }
+      if (collection_backend) {
+        const QImage thumbnail = QImage::fromData(collection_backend->GetArtThumbnail(QUrl::fromLocalFile(task.song_filename)), "JPG");
+        if (!thumbnail.isNull()) return TryLoadResult(false, true, thumbnail, cache_key);
+      }
+    }
+
     const QImage taglib_image = TagReaderClient::Instance()->LoadEmbeddedArtBlocking(task.song_filename);
 
     if (!taglib_image.isNull())
-      return TryLoadResult(false, true, ScaleAndPad(task.options, taglib_image));
+      return TryLoadResult(false, true, taglib_image, cache_key);
   }
 
   if (filename.toLower().startsWith("http://") || filename.toLower().startsWith("https://")) {
 
-    QUrl url(filename);
-    QNetworkReply *reply = network_->get(QNetworkRequest(url));
-    NewClosure(reply, SIGNAL(finished()), this, SLOT(RemoteFetchFinished(QNetworkReply*)), reply);
+    // The network access manager lives in our own thread, so the request is started from there.
+    {
+      QMutexLocker l(&mutex_);
+      remote_pending_tasks_.enqueue(task);
+    }
+    metaObject()->invokeMethod(this, "StartRemoteFetches", Qt::QueuedConnection);
 
-    remote_tasks_.insert(reply, task);
     return TryLoadResult(true, false, QImage());
   }
   else if (filename.isEmpty()) {
@@ -188,8 +287,95 @@ AlbumCoverLoader::TryLoadResult AlbumCoverLoader::TryLoadImage(const Task &task)
     return TryLoadResult(false, false, task.options.default_output_image_);
   }
 
-  QImage image(filename);
-  return TryLoadResult(false, !image.isNull(), image.isNull() ? task.options.default_output_image_ : image);
+  const QString cache_key = CacheKey(task.options, filename, "file");
+  QImage cached_image;
+  if (LoadFromCache(cache_key, &cached_image)) return TryLoadResult(false, true, cached_image, cache_key, true);
+
+  QImage image = LoadLocalImage(task.options, filename);
+  return TryLoadResult(false, !image.isNull(), image.isNull() ? task.options.default_output_image_ : image, image.isNull() ? QString() : cache_key);
+
+}
+
+QString AlbumCoverLoader::CacheKey(const AlbumCoverLoaderOptions &options, const QString &filename, const QString &type) {
+
+  // The original is not kept in the cache, only the scaled result.
+  if (options.keep_original_image_ || !options.scale_output_image_) return QString();
+
+  QFileInfo info(filename);
+  if (!info.exists()) return QString();
+
+  return QString("%1:%2:%3:%4:%5").arg(type, filename, QString::number(info.lastModified().toMSecsSinceEpoch()), QString::number(options.desired_height_), options.pad_output_image_ ? "padded" : "unpadded");
+
+}
+
+bool AlbumCoverLoader::LoadFromCache(const QString &cache_key, QImage *image) {
+
+  if (cache_key.isEmpty()) return false;
+
+  {
+    QMutexLocker l(&cache_mutex_);
+    if (QImage *cached_image = cache_.object(cache_key)) {
+      *image = *cached_image;
+      return true;
+    }
+  }
+
+  // Fall back to the thumbnail cache on disk, so the original image doesn't have to be decoded again after a restart.
+  *image = thumbnail_cache_->Load(cache_key);
+  if (image->isNull()) return false;
+
+  QMutexLocker l(&cache_mutex_);
+  cache_.insert(cache_key, new QImage(*image), qMax(1, image->byteCount() / 1024));
+
+  return true;
+
+}
+
+void AlbumCoverLoader::InsertIntoCache(const QString &cache_key, const QImage &image) {
+
+  if (cache_key.isEmpty() || image.isNull()) return;
+
+  {
+    QMutexLocker l(&cache_mutex_);
+    cache_.insert(cache_key, new QImage(image), qMax(1, image.byteCount() / 1024));
+  }
+
+  thumbnail_cache_->Save(cache_key, image);
+
+}
+
+QImage AlbumCoverLoader::LoadLocalImage(const AlbumCoverLoaderOptions &options, const QString &filename) {
+
+  QImageReader reader(filename);
+
+  // Let the image plugin decode straight to the target size if we only need the scaled image.
+  if (options.scale_output_image_ && !options.keep_original_image_) {
+    QSize size = reader.size();
+    if (size.isValid() && (size.width() > options.desired_height_ || size.height() > options.desired_height_)) {
+      size.scale(options.desired_height_, options.desired_height_, Qt::KeepAspectRatio);
+      reader.setScaledSize(size);
+    }
+  }
+
+  return reader.read();
+
+}
+
+void AlbumCoverLoader::StartRemoteFetches() {
+
+  QQueue<Task> tasks;
+  {
+    QMutexLocker l(&mutex_);
+    tasks = remote_pending_tasks_;
+    remote_pending_tasks_.clear();
+  }
+
+  for (const Task &task : tasks) {
+    const QString filename = task.state == State_TryingAuto ? task.art_automatic : task.art_manual;
+    QNetworkReply *reply = network_->get(QNetworkRequest(QUrl(filename)));
+    NewClosure(reply, SIGNAL(finished()), this, SLOT(RemoteFetchFinished(QNetworkReply*)), reply);
+    remote_tasks_.insert(reply, task);
+  }
 
 }
 
@@ -27,13 +27,16 @@
 
 #include <QtGlobal>
 #include <QObject>
+#include <QAtomicInt>
 #include <QMutex>
 #include <QQueue>
 #include <QMap>
 #include <QSet>
+#include <QCache>
 #include <QString>
 #include <QImage>
 #include <QPixmap>
+#include <QThreadPool>
 #include <QNetworkReply>
 
 #include "core/song.h"
@@ -41,16 +44,21 @@
 
 class Song;
 class NetworkAccessManager;
+class AlbumCoverThumbnailCache;
+class CollectionBackend;
 
 class AlbumCoverLoader : public QObject {
   Q_OBJECT
 
  public:
   explicit AlbumCoverLoader(QObject *parent = nullptr);
+  ~AlbumCoverLoader();
 
-  void Stop() { stop_requested_ = true; }
+  void Stop() { stop_requested_.storeRelease(1); }
+  void SetCollectionBackend(CollectionBackend *collection_backend);
 
   static QString ImageCacheDir();
+  static QString ThumbnailCacheDir();
 
   quint64 LoadImageAsync(const AlbumCoverLoaderOptions &options, const Song &song);
   virtual quint64 LoadImageAsync(const AlbumCoverLoaderOptions &options, const QString &art_automatic, const QString &art_manual, const QString &song_filename = QString(), const QImage &embedded_image = QImage());
@@ -58,8 +66,12 @@ class AlbumCoverLoader : public QObject {
   void CancelTask(quint64 id);
   void CancelTasks(const QSet<quint64> &ids);
 
+  // Moves the given tasks to the front of the queue, used for items that are currently visible.
+  void PrioritizeTasks(const QSet<quint64> &ids);
+
   static QPixmap TryLoadPixmap(const QString &automatic, const QString &manual, const QString &filename = QString());
   static QImage ScaleAndPad(const AlbumCoverLoaderOptions &options, const QImage &image);
+  static QImage LoadLocalImage(const AlbumCoverLoaderOptions &options, const QString &filename);
 
 signals:
   void ImageLoaded(quint64 id, const QImage &image);
@@ -67,6 +79,7 @@ signals:
 
  protected slots:
   void ProcessTasks();
+  void StartRemoteFetches();
   void RemoteFetchFinished(QNetworkReply *reply);
 
  protected:
@@ -90,27 +103,50 @@ signals:
   };
 
   struct TryLoadResult {
-    TryLoadResult(bool async, bool success, const QImage &i) : started_async(async), loaded_success(success), image(i) {}
+    TryLoadResult(bool async, bool success, const QImage &i, const QString &key = QString(), bool cached = false) : started_async(async), loaded_success(success), image(i), cache_key(key), from_cache(cached) {}
 
     bool started_async;
     bool loaded_success;
     QImage image;
+
+    // Set for local files and embedded covers, the scaled result is stored in the cache under this key.
+    QString cache_key;
+    // True if image is an already scaled and padded image from the memory or thumbnail cache.
+    bool from_cache;
   };
 
+  void ProcessTasksWorker();
   void ProcessTask(Task *task);
   void NextState(Task *task);
   TryLoadResult TryLoadImage(const Task &task);
 
-  bool stop_requested_;
+  static QString CacheKey(const AlbumCoverLoaderOptions &options, const QString &filename, const QString &type);
+  bool LoadFromCache(const QString &cache_key, QImage *image);
+  void InsertIntoCache(const QString &cache_key, const QImage &image);
+
+  // Written by the thread calling Stop(), read by the pool workers.
+  QAtomicInt stop_requested_;
 
   QMutex mutex_;
   QQueue<Task> tasks_;
+  QQueue<Task> remote_pending_tasks_;
   QMap<QNetworkReply *, Task> remote_tasks_;
   quint64 next_id_;
+  int running_workers_;
 
+  QThreadPool *thread_pool_;
   NetworkAccessManager *network_;
 
+  QMutex cache_mutex_;
+  QCache<QString, QImage> cache_;
+  AlbumCoverThumbnailCache *thumbnail_cache_;
+
+  // Protected by mutex_.
+  CollectionBackend *collection_backend_;
+
   static const int kMaxRedirects = 3;
+  static const int kMaxWorkers;
+  static const int kMaxCacheSize;
 };
 
 #endif  // ALBUMCOVERLOADER_H
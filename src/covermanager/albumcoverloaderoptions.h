@@ -30,11 +30,14 @@ struct AlbumCoverLoaderOptions {
   AlbumCoverLoaderOptions()
       : desired_height_(120),
         scale_output_image_(true),
-        pad_output_image_(true) {}
+        pad_output_image_(true),
+        keep_original_image_(false) {}
 
   int desired_height_;
   bool scale_output_image_;
   bool pad_output_image_;
+  // Decode the full size image so the original can be emitted along with the scaled one.
+  bool keep_original_image_;
   QImage default_output_image_;
 };
 
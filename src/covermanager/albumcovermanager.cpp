@@ -49,6 +49,8 @@
 #include <QStatusBar>
 #include <QLabel>
 #include <QListWidget>
+#include <QScrollBar>
+#include <QRect>
 #include <QMessageBox>
 #include <QProgressBar>
 #include <QPushButton>
@@ -84,12 +86,16 @@
 using std::stable_sort;
 
 const char *AlbumCoverManager::kSettingsGroup = "CoverManager";
+const int AlbumCoverManager::kAlbumsPageSize = 500;
 
 AlbumCoverManager::AlbumCoverManager(Application *app, CollectionBackend *collection_backend, QWidget *parent, QNetworkAccessManager *network)
     : QMainWindow(parent),
       ui_(new Ui_CoverManager),
       app_(app),
       album_cover_choice_controller_(new AlbumCoverChoiceController(this)),
+      visible_covers_timer_(new QTimer(this)),
+      add_albums_timer_(new QTimer(this)),
+      albums_added_(0),
       cover_fetcher_(new AlbumCoverFetcher(app_->cover_providers(), this, network)),
       cover_searcher_(nullptr),
       cover_export_(nullptr),
@@ -135,6 +141,17 @@ AlbumCoverManager::AlbumCoverManager(Application *app, CollectionBackend *collec
   QShortcut *close = new QShortcut(QKeySequence::Close, this);
   connect(close, SIGNAL(activated()), SLOT(close()));
 
+  // Only load the covers that are scrolled into view
+  visible_covers_timer_->setSingleShot(true);
+  visible_covers_timer_->setInterval(50);
+  connect(visible_covers_timer_, SIGNAL(timeout()), SLOT(LoadVisibleCovers()));
+  connect(ui_->albums->verticalScrollBar(), SIGNAL(valueChanged(int)), visible_covers_timer_, SLOT(start()));
+
+  // Add the albums a page at a time so the window stays responsive with large collections
+  add_albums_timer_->setSingleShot(true);
+  add_albums_timer_->setInterval(0);
+  connect(add_albums_timer_, SIGNAL(timeout()), SLOT(AddAlbumsPage()));
+
   EnableCoversButtons();
 
 }
@@ -250,6 +267,10 @@ void AlbumCoverManager::closeEvent(QCloseEvent *e) {
 
 void AlbumCoverManager::CancelRequests() {
 
+  // The covers are requested again when they are visible
+  for (QListWidgetItem *item : cover_loading_tasks_) {
+    item->setData(Role_CoverLoad, CoverLoad_Pending);
+  }
   app_->album_cover_loader()->CancelTasks(QSet<quint64>::fromList(cover_loading_tasks_.keys()));
   cover_loading_tasks_.clear();
 
@@ -264,6 +285,17 @@ void AlbumCoverManager::CancelRequests() {
 
 }
 
+// Whether the stored art paths of an album point to a cover, without loading it.
+static bool ArtPathsHaveCover(const QString &art_automatic, const QString &art_manual) {
+
+  // Only look at the stored paths, this runs on the UI thread while paging albums, so the files are not checked here.
+  // A path that no longer points to a file is counted as without cover once the loader returns a null image.
+  if (art_manual == Song::kManuallyUnsetCover) return false;
+
+  return !art_manual.isEmpty() || !art_automatic.isEmpty();
+
+}
+
 static bool CompareNocase(const QString &left, const QString &right) {
   return QString::localeAwareCompare(left, right) < 0;
 }
@@ -304,18 +336,16 @@ void AlbumCoverManager::ArtistChanged(QListWidgetItem *current) {
 
   if (!current) return;
 
-  QString artist;
-  if (current->type() == Specific_Artist) artist = current->text();
-
+  CancelRequests();
+  add_albums_timer_->stop();
   ui_->albums->clear();
   context_menu_items_.clear();
-  CancelRequests();
 
   // Get the list of albums.  How we do it depends on what thing we have selected in the artist list.
   CollectionBackend::AlbumList albums;
   switch (current->type()) {
     case Various_Artists: albums = collection_backend_->GetCompilationAlbums(); break;
-    case Specific_Artist: albums = collection_backend_->GetAlbumsByArtist(current->text()); break;
+    case Specific_Artist: albums = collection_backend_->GetAlbumsByAlbumArtist(current->text()); break;
     case All_Artists:
     default:              albums = collection_backend_->GetAllAlbums(); break;
   }
@@ -323,7 +353,23 @@ void AlbumCoverManager::ArtistChanged(QListWidgetItem *current) {
   // Sort by album name.  The list is already sorted by sqlite but it was done case sensitively.
   std::stable_sort(albums.begin(), albums.end(), CompareAlbumNameNocase);
 
-  for (const CollectionBackend::Album &info : albums) {
+  albums_to_add_ = albums;
+  albums_added_ = 0;
+  AddAlbumsPage();
+
+}
+
+void AlbumCoverManager::AddAlbumsPage() {
+
+  QListWidgetItem *current = ui_->artists->currentItem();
+  const bool specific_artist = current && current->type() == Specific_Artist;
+  const QString filter = ui_->filter->text().toLower();
+  const HideCovers hide = CurrentHideCovers();
+
+  const int end = qMin(albums_added_ + kAlbumsPageSize, albums_to_add_.count());
+  for (; albums_added_ < end; ++albums_added_) {
+    const CollectionBackend::Album &info = albums_to_add_[albums_added_];
+
     // Don't show songs without an album, obviously
     if (info.album_name.isEmpty()) continue;
 
@@ -334,25 +380,79 @@ void AlbumCoverManager::ArtistChanged(QListWidgetItem *current) {
     item->setData(Role_FirstUrl, info.first_url);
     item->setData(Qt::TextAlignmentRole, QVariant(Qt::AlignTop | Qt::AlignHCenter));
     item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled);
-    item->setToolTip(info.artist + " - " + info.album_name);
 
-    QString effective_artist = EffectiveAlbumArtistName(*item);
-    if (!artist.isEmpty()) {
-      item->setToolTip(effective_artist + " - " + info.album_name);
+    if (specific_artist) {
+      item->setToolTip(EffectiveAlbumArtistName(*item) + " - " + info.album_name);
     }
     else {
       item->setToolTip(info.album_name);
     }
 
     if (!info.art_automatic.isEmpty() || !info.art_manual.isEmpty()) {
-      quint64 id = app_->album_cover_loader()->LoadImageAsync(cover_loader_options_, info.art_automatic, info.art_manual, info.first_url.toLocalFile());
       item->setData(Role_PathAutomatic, info.art_automatic);
       item->setData(Role_PathManual, info.art_manual);
-      cover_loading_tasks_[id] = item;
+      // Only albums whose stored art points to a cover wait for it to load, the rest show as without cover right away.
+      if (ArtPathsHaveCover(info.art_automatic, info.art_manual)) {
+        item->setData(Role_CoverLoad, CoverLoad_Pending);
+      }
     }
+
+    item->setHidden(ShouldHide(*item, filter, hide));
   }
 
-  UpdateFilter();
+  if (albums_added_ < albums_to_add_.count()) {
+    add_albums_timer_->start();
+  }
+  else {
+    albums_to_add_.clear();
+    albums_added_ = 0;
+    UpdateFilter();
+  }
+
+  visible_covers_timer_->start();
+
+}
+
+void AlbumCoverManager::LoadVisibleCovers() {
+
+  // Also load the covers a page above and below the viewport, so they are there when scrolling.
+  const QRect viewport_rect = ui_->albums->viewport()->rect();
+  const QRect rect = viewport_rect.adjusted(0, -viewport_rect.height(), 0, viewport_rect.height());
+
+  // Stop loading covers that were scrolled away from before they finished
+  QSet<quint64> cancel_ids;
+  for (QMap<quint64, QListWidgetItem*>::iterator it = cover_loading_tasks_.begin(); it != cover_loading_tasks_.end();) {
+    QListWidgetItem *item = it.value();
+    if (item->isHidden() || !ui_->albums->visualItemRect(item).intersects(rect)) {
+      item->setData(Role_CoverLoad, CoverLoad_Pending);
+      cancel_ids << it.key();
+      it = cover_loading_tasks_.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+  if (!cancel_ids.isEmpty()) app_->album_cover_loader()->CancelTasks(cancel_ids);
+
+  QSet<quint64> visible_ids;
+  for (int i = 0; i < ui_->albums->count(); ++i) {
+    QListWidgetItem *item = ui_->albums->item(i);
+    if (item->isHidden()) continue;
+
+    // Items are laid out left to right and top to bottom, so nothing after this one is visible.
+    const QRect item_rect = ui_->albums->visualItemRect(item);
+    if (item_rect.top() > rect.bottom()) break;
+
+    if (item->data(Role_CoverLoad).toInt() != CoverLoad_Pending || !item_rect.intersects(rect)) continue;
+
+    quint64 id = app_->album_cover_loader()->LoadImageAsync(cover_loader_options_, item->data(Role_PathAutomatic).toString(), item->data(Role_PathManual).toString(), item->data(Role_FirstUrl).toUrl().toLocalFile());
+    item->setData(Role_CoverLoad, CoverLoad_Requested);
+    cover_loading_tasks_[id] = item;
+    if (item_rect.intersects(viewport_rect)) visible_ids << id;
+  }
+
+  // Load what is actually visible before the covers around it
+  if (!visible_ids.isEmpty()) app_->album_cover_loader()->PrioritizeTasks(visible_ids);
 
 }
 
@@ -361,27 +461,34 @@ void AlbumCoverManager::CoverImageLoaded(quint64 id, const QImage &image) {
   if (!cover_loading_tasks_.contains(id)) return;
 
   QListWidgetItem *item = cover_loading_tasks_.take(id);
+  item->setData(Role_CoverLoad, CoverLoad_None);
 
-  if (image.isNull()) return;
+  // Albums with a cover still to load are counted as having one from their stored art, so the filter only changes when it failed to load.
+  if (image.isNull()) {
+    UpdateFilter();
+    return;
+  }
 
   item->setIcon(QPixmap::fromImage(image));
-  UpdateFilter();
 
 }
 
-void AlbumCoverManager::UpdateFilter() {
+AlbumCoverManager::HideCovers AlbumCoverManager::CurrentHideCovers() const {
 
-  const QString filter = ui_->filter->text().toLower();
-  const bool hide_with_covers = filter_without_covers_->isChecked();
-  const bool hide_without_covers = filter_with_covers_->isChecked();
-
-  HideCovers hide = Hide_None;
-  if (hide_with_covers) {
-    hide = Hide_WithCovers;
+  if (filter_without_covers_->isChecked()) {
+    return Hide_WithCovers;
   }
-  else if (hide_without_covers) {
-    hide = Hide_WithoutCovers;
+  else if (filter_with_covers_->isChecked()) {
+    return Hide_WithoutCovers;
   }
+  return Hide_None;
+
+}
+
+void AlbumCoverManager::UpdateFilter() {
+
+  const QString filter = ui_->filter->text().toLower();
+  const HideCovers hide = CurrentHideCovers();
 
   qint32 total_count = 0;
   qint32 without_cover = 0;
@@ -402,6 +509,8 @@ void AlbumCoverManager::UpdateFilter() {
   ui_->total_albums->setText(QString::number(total_count));
   ui_->without_cover->setText(QString::number(without_cover));
 
+  visible_covers_timer_->start();
+
 }
 
 bool AlbumCoverManager::ShouldHide(const QListWidgetItem &item, const QString &filter, HideCovers hide) const {
@@ -439,7 +548,7 @@ void AlbumCoverManager::FetchAlbumCovers() {
     if (item->isHidden()) continue;
     if (ItemHasCover(*item)) continue;
 
-    quint64 id = cover_fetcher_->FetchAlbumCover(EffectiveAlbumArtistName(*item), item->data(Role_AlbumName).toString(), true);
+    quint64 id = cover_fetcher_->FetchAlbumCover(EffectiveAlbumArtistName(*item), item->data(Role_AlbumName).toString(), true, true);
     cover_fetching_tasks_[id] = item;
     jobs_++;
   }
@@ -503,6 +612,10 @@ void AlbumCoverManager::UpdateStatusText() {
 
 bool AlbumCoverManager::eventFilter(QObject *obj, QEvent *event) {
 
+  if (obj == ui_->albums && event->type() == QEvent::Resize) {
+    visible_covers_timer_->start();
+  }
+
   if (obj == ui_->albums && event->type() == QEvent::ContextMenu) {
     context_menu_items_ = ui_->albums->selectedItems();
     if (context_menu_items_.isEmpty()) return false;
@@ -590,7 +703,9 @@ void AlbumCoverManager::UpdateCoverInList(QListWidgetItem *item, const QString &
 
   quint64 id = app_->album_cover_loader()->LoadImageAsync(cover_loader_options_, QString(), cover);
   item->setData(Role_PathManual, cover);
+  item->setData(Role_CoverLoad, CoverLoad_Requested);
   cover_loading_tasks_[id] = item;
+  UpdateFilter();
 
 }
 
@@ -687,6 +802,7 @@ void AlbumCoverManager::UnsetCover() {
   for (QListWidgetItem *current : context_menu_items_) {
     current->setIcon(no_cover_item_icon_);
     current->setData(Role_PathManual, cover);
+    current->setData(Role_CoverLoad, CoverLoad_None);
 
     // Don't save the first one twice
     if (current != item) {
@@ -791,7 +907,9 @@ void AlbumCoverManager::SaveAndSetCover(QListWidgetItem *item, const QImage &ima
   // Update the icon in our list
   quint64 id = app_->album_cover_loader()->LoadImageAsync(cover_loader_options_, QString(), path);
   item->setData(Role_PathManual, path);
+  item->setData(Role_CoverLoad, CoverLoad_Requested);
   cover_loading_tasks_[id] = item;
+  UpdateFilter();
 
 }
 
@@ -886,6 +1004,11 @@ QImage AlbumCoverManager::GenerateNoCoverImage(const QIcon &no_cover_icon) const
 }
 
 bool AlbumCoverManager::ItemHasCover(const QListWidgetItem &item) const {
+
+  // A cover is only waited for when the stored art points to one, otherwise the result of the load decides.
+  if (item.data(Role_CoverLoad).toInt() != CoverLoad_None) return true;
+
   return item.icon().cacheKey() != no_cover_item_icon_.cacheKey();
+
 }
 
@@ -42,14 +42,15 @@
 #include <QMimeData>
 #include <QProgressBar>
 #include <QPushButton>
+#include <QTimer>
 #include <QtEvents>
 
 #include "core/song.h"
+#include "collection/collectionbackend.h"
 #include "albumcoverloaderoptions.h"
 #include "coversearchstatistics.h"
 
 class Application;
-class CollectionBackend;
 class SongMimeData;
 class AlbumCoverChoiceController;
 class AlbumCoverExport;
@@ -66,6 +67,7 @@ class AlbumCoverManager : public QMainWindow {
   ~AlbumCoverManager();
 
   static const char *kSettingsGroup;
+  static const int kAlbumsPageSize;
 
   CollectionBackend *backend() const;
   QIcon no_cover_icon() const { return no_cover_icon_; }
@@ -94,6 +96,8 @@ class AlbumCoverManager : public QMainWindow {
  private slots:
   void ArtistChanged(QListWidgetItem *current);
   void CoverImageLoaded(quint64 id, const QImage &image);
+  void AddAlbumsPage();
+  void LoadVisibleCovers();
   void UpdateFilter();
   void FetchAlbumCovers();
   void ExportCovers();
@@ -131,7 +135,15 @@ class AlbumCoverManager : public QMainWindow {
     Role_AlbumName,
     Role_PathAutomatic,
     Role_PathManual,
-    Role_FirstUrl
+    Role_FirstUrl,
+    Role_CoverLoad
+  };
+
+  // Covers are only loaded once their album is scrolled into view.
+  enum CoverLoad {
+    CoverLoad_None,
+    CoverLoad_Pending,
+    CoverLoad_Requested
   };
 
   enum HideCovers {
@@ -151,6 +163,7 @@ class AlbumCoverManager : public QMainWindow {
   Song ItemAsSong(QListWidgetItem *item);
 
   void UpdateStatusText();
+  HideCovers CurrentHideCovers() const;
   bool ShouldHide(const QListWidgetItem &item, const QString &filter, HideCovers hide) const;
   void SaveAndSetCover(QListWidgetItem *item, const QImage &image);
 
@@ -166,6 +179,12 @@ class AlbumCoverManager : public QMainWindow {
 
   AlbumCoverLoaderOptions cover_loader_options_;
   QMap<quint64, QListWidgetItem*> cover_loading_tasks_;
+  QTimer *visible_covers_timer_;
+
+  // Albums of the selected artist that are still to be added to the list.
+  QTimer *add_albums_timer_;
+  CollectionBackend::AlbumList albums_to_add_;
+  int albums_added_;
 
   AlbumCoverFetcher *cover_fetcher_;
   QMap<quint64, QListWidgetItem*> cover_fetching_tasks_;
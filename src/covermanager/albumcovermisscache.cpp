@@ -0,0 +1,159 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QString>
+#include <QTimer>
+
+#include "core/logging.h"
+#include "albumcovermisscache.h"
+
+const int AlbumCoverMissCache::kExpireDays = 30;
+
+namespace {
+const quint32 kFileMagic = 0x5343564d;  // "SCVM"
+const quint32 kFileVersion = 1;
+const int kSaveDelayMs = 5000;
+}
+
+AlbumCoverMissCache::AlbumCoverMissCache(QObject *parent)
+    : QObject(parent),
+      filename_(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/coversearchmisses.dat"),
+      timer_save_(new QTimer(this)),
+      loaded_(false),
+      dirty_(false) {
+
+  timer_save_->setSingleShot(true);
+  timer_save_->setInterval(kSaveDelayMs);
+  connect(timer_save_, SIGNAL(timeout()), SLOT(WriteCache()));
+
+}
+
+AlbumCoverMissCache::~AlbumCoverMissCache() {
+  WriteCache();
+}
+
+QString AlbumCoverMissCache::Key(const QString &artist, const QString &album) {
+  return artist.toLower().simplified() + QChar('\n') + album.toLower().simplified();
+}
+
+bool AlbumCoverMissCache::Contains(const QString &artist, const QString &album) {
+
+  QMutexLocker l(&mutex_);
+  ReadCache();
+
+  const QString key = Key(artist, album);
+  if (!misses_.contains(key)) return false;
+
+  if (QDateTime::fromMSecsSinceEpoch(misses_[key]).daysTo(QDateTime::currentDateTime()) >= kExpireDays) {
+    misses_.remove(key);
+    dirty_ = true;
+    return false;
+  }
+
+  return true;
+
+}
+
+void AlbumCoverMissCache::Add(const QString &artist, const QString &album) {
+
+  QMutexLocker l(&mutex_);
+  ReadCache();
+
+  misses_.insert(Key(artist, album), QDateTime::currentMSecsSinceEpoch());
+  dirty_ = true;
+  QMetaObject::invokeMethod(timer_save_, "start", Qt::QueuedConnection);
+
+}
+
+void AlbumCoverMissCache::Remove(const QString &artist, const QString &album) {
+
+  QMutexLocker l(&mutex_);
+  ReadCache();
+
+  if (misses_.remove(Key(artist, album)) > 0) {
+    dirty_ = true;
+    QMetaObject::invokeMethod(timer_save_, "start", Qt::QueuedConnection);
+  }
+
+}
+
+void AlbumCoverMissCache::ReadCache() {
+
+  if (loaded_) return;
+  loaded_ = true;
+
+  QFile file(filename_);
+  if (!file.exists()) return;
+  if (!file.open(QIODevice::ReadOnly)) {
+    qLog(Error) << "Unable to open cover search miss cache" << filename_ << file.errorString();
+    return;
+  }
+
+  QDataStream s(&file);
+  quint32 magic = 0;
+  quint32 version = 0;
+  s >> magic >> version;
+  if (magic != kFileMagic || version != kFileVersion) {
+    qLog(Error) << "Ignoring cover search miss cache" << filename_ << "with unknown format";
+    return;
+  }
+  s >> misses_;
+  if (s.status() != QDataStream::Ok) {
+    qLog(Error) << "Failed to read cover search miss cache" << filename_;
+    misses_.clear();
+  }
+
+}
+
+void AlbumCoverMissCache::WriteCache() {
+
+  QMutexLocker l(&mutex_);
+  if (!dirty_) return;
+
+  QDir().mkpath(QFileInfo(filename_).path());
+
+  QSaveFile file(filename_);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qLog(Error) << "Unable to open cover search miss cache" << filename_ << "for writing:" << file.errorString();
+    return;
+  }
+
+  QDataStream s(&file);
+  s << kFileMagic << kFileVersion << misses_;
+  if (!file.commit()) {
+    qLog(Error) << "Failed to write cover search miss cache" << filename_;
+    return;
+  }
+
+  dirty_ = false;
+
+}
@@ -0,0 +1,68 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ALBUMCOVERMISSCACHE_H
+#define ALBUMCOVERMISSCACHE_H
+
+#include "config.h"
+
+#include <stdbool.h>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QString>
+
+class QTimer;
+
+// Remembers albums that no cover provider had a cover for, so "Fetch Missing Covers" doesn't search for them again on every run.
+// Entries expire after kExpireDays so new covers added to the providers are eventually picked up.  The class is thread safe.
+class AlbumCoverMissCache : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit AlbumCoverMissCache(QObject *parent = nullptr);
+  ~AlbumCoverMissCache();
+
+  static const int kExpireDays;
+
+  bool Contains(const QString &artist, const QString &album);
+  void Add(const QString &artist, const QString &album);
+  void Remove(const QString &artist, const QString &album);
+
+ private slots:
+  void WriteCache();
+
+ private:
+  static QString Key(const QString &artist, const QString &album);
+  void ReadCache();
+
+  QMutex mutex_;
+  QString filename_;
+  QTimer *timer_save_;
+  bool loaded_;
+  bool dirty_;
+
+  // Maps the normalized artist and album to the time of the last search that found nothing.
+  QHash<QString, qint64> misses_;
+
+};
+
+#endif  // ALBUMCOVERMISSCACHE_H
@@ -0,0 +1,159 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#  include <utime.h>
+#endif
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileInfoList>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QString>
+#include <QCryptographicHash>
+#include <QImage>
+#include <QImageReader>
+
+#include "core/logging.h"
+#include "albumcoverthumbnailcache.h"
+
+const qint64 AlbumCoverThumbnailCache::kDefaultMaxSize = 256 * 1024 * 1024;
+
+namespace {
+
+// Thumbnails are small, so PNG with light compression decodes faster than the original JPEG while still keeping the alpha channel of padded covers.
+const char *kImageFormat = "PNG";
+const int kImageQuality = 80;
+const char *kFileSuffix = ".png";
+// Used thumbnails are touched at most this often, so loading covers doesn't write to the disk all the time.
+const int kTouchIntervalSecs = 3600;
+
+bool CompareLastModified(const QFileInfo &left, const QFileInfo &right) {
+  return left.lastModified() < right.lastModified();
+}
+
+}  // namespace
+
+AlbumCoverThumbnailCache::AlbumCoverThumbnailCache(const QString &path, const qint64 max_size)
+    : path_(path),
+      max_size_(max_size),
+      current_size_(0),
+      scanned_(false) {}
+
+QString AlbumCoverThumbnailCache::Filename(const QString &key) const {
+  return path_ + "/" + QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex() + kFileSuffix;
+}
+
+QImage AlbumCoverThumbnailCache::Load(const QString &key) {
+
+  if (key.isEmpty()) return QImage();
+
+  const QString filename = Filename(key);
+  const QFileInfo info(filename);
+  if (!info.exists()) return QImage();
+
+  QImageReader reader(filename, kImageFormat);
+  const QImage image = reader.read();
+
+  if (!image.isNull() && info.lastModified().secsTo(QDateTime::currentDateTime()) > kTouchIntervalSecs) Touch(filename);
+
+  return image;
+
+}
+
+void AlbumCoverThumbnailCache::Touch(const QString &filename) {
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+  QFile file(filename);
+  if (file.open(QIODevice::ReadWrite)) file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+#elif defined(Q_OS_UNIX)
+  utime(QFile::encodeName(filename).constData(), nullptr);
+#else
+  Q_UNUSED(filename);
+#endif
+
+}
+
+void AlbumCoverThumbnailCache::Save(const QString &key, const QImage &image) {
+
+  if (key.isEmpty() || image.isNull()) return;
+
+  QMutexLocker l(&mutex_);
+
+  if (!QDir().mkpath(path_)) return;
+  ScanSize();
+
+  const QString filename = Filename(key);
+  // An existing entry is replaced, so its size no longer counts.
+  const QFileInfo old_info(filename);
+  const qint64 old_size = old_info.exists() ? old_info.size() : 0;
+
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qLog(Error) << "Failed to open thumbnail" << filename << "for writing:" << file.errorString();
+    return;
+  }
+  if (!image.save(&file, kImageFormat, kImageQuality) || !file.commit()) {
+    qLog(Error) << "Failed to save thumbnail" << filename;
+    return;
+  }
+
+  current_size_ += QFileInfo(filename).size() - old_size;
+  if (current_size_ > max_size_) Trim();
+
+}
+
+void AlbumCoverThumbnailCache::ScanSize() {
+
+  if (scanned_) return;
+  scanned_ = true;
+
+  current_size_ = 0;
+  for (const QFileInfo &info : QDir(path_).entryInfoList(QStringList() << QString("*") + kFileSuffix, QDir::Files)) {
+    current_size_ += info.size();
+  }
+
+}
+
+void AlbumCoverThumbnailCache::Trim() {
+
+  // Remove the least recently used thumbnails until we're well below the limit, so this doesn't run on every insert.
+  QFileInfoList files = QDir(path_).entryInfoList(QStringList() << QString("*") + kFileSuffix, QDir::Files);
+  std::sort(files.begin(), files.end(), CompareLastModified);
+
+  const qint64 target_size = max_size_ * 9 / 10;
+  current_size_ = 0;
+  for (const QFileInfo &info : files) current_size_ += info.size();
+
+  for (const QFileInfo &info : files) {
+    if (current_size_ <= target_size) break;
+    if (QFile::remove(info.absoluteFilePath())) current_size_ -= info.size();
+  }
+
+  qLog(Debug) << "Trimmed thumbnail cache to" << current_size_ << "bytes";
+
+}
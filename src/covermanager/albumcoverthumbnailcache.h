@@ -0,0 +1,57 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ALBUMCOVERTHUMBNAILCACHE_H
+#define ALBUMCOVERTHUMBNAILCACHE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QString>
+#include <QImage>
+
+// Persistent store for scaled album covers.
+// Thumbnails are saved as files named after a hash of the cache key, so a changed source file or size results in a new entry and stale entries are eventually evicted.
+// The modification time of a file is its last use, since access times aren't updated on most mounts.
+class AlbumCoverThumbnailCache {
+
+ public:
+  explicit AlbumCoverThumbnailCache(const QString &path, const qint64 max_size = kDefaultMaxSize);
+
+  static const qint64 kDefaultMaxSize;
+
+  QImage Load(const QString &key);
+  void Save(const QString &key, const QImage &image);
+
+ private:
+  QString Filename(const QString &key) const;
+  static void Touch(const QString &filename);
+  void ScanSize();
+  void Trim();
+
+  QMutex mutex_;
+  QString path_;
+  qint64 max_size_;
+  qint64 current_size_;
+  bool scanned_;
+
+};
+
+#endif  // ALBUMCOVERTHUMBNAILCACHE_H
@@ -20,10 +20,122 @@
 
 #include "config.h"
 
+#include <QtGlobal>
 #include <QObject>
+#include <QQueue>
 #include <QString>
+#include <QElapsedTimer>
 
+#include "core/logging.h"
+#include "albumcoverfetcher.h"
 #include "coverprovider.h"
 
+const int CoverProvider::kInitialConcurrentSearches = 2;
+const int CoverProvider::kMaxConcurrentSearches = 5;
+const int CoverProvider::kSlowSearchMs = 5000;
+
 CoverProvider::CoverProvider(const QString &name, const bool &fetchall, QObject *parent)
-    : QObject(parent), name_(name), fetchall_(fetchall) {}
+    : QObject(parent),
+      name_(name),
+      fetchall_(fetchall),
+      max_concurrent_searches_(kInitialConcurrentSearches),
+      fast_searches_(0) {
+
+  clock_.start();
+  connect(this, SIGNAL(SearchFinished(int, QList<CoverSearchResult>)), SLOT(QueuedSearchFinished(int)));
+
+}
+
+bool CoverProvider::QueueSearch(const QString &artist, const QString &album, int id) {
+
+  if (running_searches_.count() < max_concurrent_searches_ && queued_searches_.isEmpty()) {
+    if (!StartSearch(artist, album, id)) return false;
+    running_searches_.insert(id, clock_.elapsed());
+    return true;
+  }
+
+  QueuedSearch search;
+  search.artist = artist;
+  search.album = album;
+  search.id = id;
+  queued_searches_.enqueue(search);
+
+  return true;
+
+}
+
+void CoverProvider::CancelQueuedSearch(int id, const bool timed_out) {
+
+  for (QQueue<QueuedSearch>::iterator it = queued_searches_.begin(); it != queued_searches_.end(); ++it) {
+    if (it->id == id) {
+      queued_searches_.erase(it);
+      return;
+    }
+  }
+
+  if (!running_searches_.contains(id)) return;
+
+  // Release the slot right away, a provider whose reply hangs would otherwise hold it for good.
+  // The finish the provider may still send later is ignored.
+  const qint64 elapsed = clock_.elapsed() - running_searches_.take(id);
+  failed_searches_.remove(id);
+  cancelled_searches_ << id;
+  CancelSearch(id);
+
+  // Only a search that timed out says something about the provider, a cancel by the user doesn't.
+  if (timed_out) UpdateConcurrency(false, elapsed);
+
+  StartQueuedSearches();
+
+}
+
+void CoverProvider::QueuedSearchFinished(int id) {
+
+  if (cancelled_searches_.remove(id)) {
+    failed_searches_.remove(id);
+    return;
+  }
+
+  if (!running_searches_.contains(id)) return;
+
+  const qint64 elapsed = clock_.elapsed() - running_searches_.take(id);
+  const bool failed = failed_searches_.remove(id);
+  UpdateConcurrency(!failed && elapsed < kSlowSearchMs, elapsed);
+  StartQueuedSearches();
+
+}
+
+void CoverProvider::StartQueuedSearches() {
+
+  while (!queued_searches_.isEmpty() && running_searches_.count() < max_concurrent_searches_) {
+    QueuedSearch search = queued_searches_.dequeue();
+    if (StartSearch(search.artist, search.album, search.id)) {
+      running_searches_.insert(search.id, clock_.elapsed());
+    }
+    else {
+      // The search was already accepted, so let the waiting AlbumCoverFetcherSearch know there are no results.
+      emit SearchFinished(search.id, QList<CoverSearchResult>());
+    }
+  }
+
+}
+
+void CoverProvider::UpdateConcurrency(const bool success, const qint64 elapsed) {
+
+  // Additive increase after a full round of fast searches, multiplicative decrease on slow or failed ones.
+  if (success) {
+    if (++fast_searches_ >= max_concurrent_searches_ && max_concurrent_searches_ < kMaxConcurrentSearches) {
+      ++max_concurrent_searches_;
+      fast_searches_ = 0;
+      qLog(Debug) << "Raised concurrent searches for" << name_ << "to" << max_concurrent_searches_;
+    }
+  }
+  else {
+    fast_searches_ = 0;
+    if (max_concurrent_searches_ > 1) {
+      max_concurrent_searches_ = qMax(1, max_concurrent_searches_ / 2);
+      qLog(Debug) << "Lowered concurrent searches for" << name_ << "to" << max_concurrent_searches_ << "after" << elapsed << "ms";
+    }
+  }
+
+}
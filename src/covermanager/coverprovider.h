@@ -25,9 +25,14 @@
 
 #include <stdbool.h>
 
+#include <QtGlobal>
 #include <QObject>
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QQueue>
 #include <QString>
+#include <QElapsedTimer>
 
 struct CoverSearchResult;
 
@@ -50,13 +55,52 @@ public:
 
   virtual void CancelSearch(int id) {}
 
+  // Starts the search if fewer than max_concurrent_searches() are running, otherwise it's queued until one finishes.
+  // The limit is raised while the provider answers quickly and lowered when it's slow or searches time out.
+  bool QueueSearch(const QString &artist, const QString &album, int id);
+
+  // Removes a queued search, or cancels a running one.
+  // A running search keeps its slot until the provider finishes it, timed out searches also lower the limit.
+  void CancelQueuedSearch(int id, const bool timed_out = false);
+
+  int max_concurrent_searches() const { return max_concurrent_searches_; }
+
 signals:
   void SearchFinished(int id, const QList<CoverSearchResult>& results);
 
+protected:
+  // Called by implementations when a search failed because of a network or server error, it lowers the limit when the search finishes.
+  void SetSearchFailed(int id) { failed_searches_ << id; }
+
+private slots:
+  void QueuedSearchFinished(int id);
+
 private:
+  struct QueuedSearch {
+    QString artist;
+    QString album;
+    int id;
+  };
+
+  void StartQueuedSearches();
+  void UpdateConcurrency(const bool success, const qint64 elapsed);
+
+  static const int kInitialConcurrentSearches;
+  static const int kMaxConcurrentSearches;
+  static const int kSlowSearchMs;
+
   QString name_;
   bool fetchall_;
 
+  QQueue<QueuedSearch> queued_searches_;
+  QHash<int, qint64> running_searches_;
+  // Searches cancelled while running, their slot is already free and a late finish from the provider is ignored.
+  QSet<int> cancelled_searches_;
+  QSet<int> failed_searches_;
+  QElapsedTimer clock_;
+  int max_concurrent_searches_;
+  int fast_searches_;
+
 };
 
 #endif // COVERPROVIDER_H
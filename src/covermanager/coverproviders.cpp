@@ -28,8 +28,9 @@
 #include "core/logging.h"
 #include "coverprovider.h"
 #include "coverproviders.h"
+#include "albumcovermisscache.h"
 
-CoverProviders::CoverProviders(QObject *parent) : QObject(parent) {}
+CoverProviders::CoverProviders(QObject *parent) : QObject(parent), miss_cache_(new AlbumCoverMissCache(this)) {}
 
 void CoverProviders::AddProvider(CoverProvider *provider) {
 
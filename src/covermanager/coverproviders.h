@@ -34,6 +34,7 @@
 #include <QAtomicInt>
 
 class CoverProvider;
+class AlbumCoverMissCache;
 
 // This is a repository for cover providers.
 // Providers are automatically unregistered from the repository when they are deleted.  The class is thread safe.
@@ -55,6 +56,9 @@ class CoverProviders : public QObject {
 
   int NextId();
 
+  // Albums recently searched for without finding a cover, shared by all AlbumCoverFetchers.
+  AlbumCoverMissCache *miss_cache() const { return miss_cache_; }
+
  private slots:
   void ProviderDestroyed();
 
@@ -65,6 +69,8 @@ class CoverProviders : public QObject {
   QMutex mutex_;
 
   QAtomicInt next_id_;
+
+  AlbumCoverMissCache *miss_cache_;
 };
 
 #endif  // COVERPROVIDERS_H
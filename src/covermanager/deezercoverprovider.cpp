@@ -191,6 +191,7 @@ void DeezerCoverProvider::HandleSearchReply(QNetworkReply *reply, int id) {
 
   QByteArray data = GetReplyData(reply);
   if (data.isEmpty()) {
+    SetSearchFailed(id);
     emit SearchFinished(id, results);
     return;
   }
@@ -63,6 +63,7 @@ bool DiscogsCoverProvider::StartSearch(const QString &artist, const QString &alb
   s_ctx->artist = artist;
   s_ctx->album = album;
   s_ctx->r_count = 0;
+  s_ctx->cancelled = false;
   requests_search_.insert(s_id, s_ctx);
   SendSearchRequest(s_ctx);
 
@@ -71,7 +72,14 @@ bool DiscogsCoverProvider::StartSearch(const QString &artist, const QString &alb
 }
 
 void DiscogsCoverProvider::CancelSearch(int id) {
-  delete requests_search_.take(id);
+
+  // Keep the context until the running requests finish, so the search still ends with SearchFinished.
+  if (requests_search_.contains(id)) {
+    DiscogsCoverSearchContext *s_ctx = requests_search_.value(id);
+    s_ctx->cancelled = true;
+    s_ctx->results.clear();
+  }
+
 }
 
 
@@ -272,8 +280,14 @@ void DiscogsCoverProvider::HandleSearchReply(QNetworkReply *reply, int s_id) {
   }
   DiscogsCoverSearchContext *s_ctx = requests_search_.value(s_id);
 
+  if (s_ctx->cancelled) {
+    EndSearch(s_ctx);
+    return;
+  }
+
   QByteArray data = GetReplyData(reply);
   if (data.isEmpty()) {
+    SetSearchFailed(s_id);
     EndSearch(s_ctx);
     return;
   }
@@ -334,8 +348,14 @@ void DiscogsCoverProvider::HandleReleaseReply(QNetworkReply *reply, int s_id, in
   }
   DiscogsCoverSearchContext *s_ctx = requests_search_.value(s_id);
 
+  if (s_ctx->cancelled) {
+    EndSearch(s_ctx, r_ctx);
+    return;
+  }
+
   QByteArray data = GetReplyData(reply);
   if (data.isEmpty()) {
+    SetSearchFailed(s_id);
     EndSearch(s_ctx);
     return;
   }
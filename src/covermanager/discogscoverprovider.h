@@ -47,6 +47,8 @@ struct DiscogsCoverSearchContext {
   QString album;
   QString title;
   int r_count;
+  // Set when the search was cancelled, it's finished without results once its running requests are done.
+  bool cancelled;
 
   CoverSearchResults results;
 };
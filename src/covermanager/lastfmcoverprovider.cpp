@@ -94,6 +94,7 @@ void LastFmCoverProvider::QueryFinished(QNetworkReply *reply, int id) {
 
   QByteArray data = GetReplyData(reply);
   if (data.isEmpty()) {
+    SetSearchFailed(id);
     emit SearchFinished(id, results);
     return;
   }
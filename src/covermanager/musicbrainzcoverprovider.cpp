@@ -80,6 +80,7 @@ void MusicbrainzCoverProvider::HandleSearchReply(QNetworkReply *reply, int searc
 
   QByteArray data = GetReplyData(reply);
   if (data.isEmpty()) {
+    SetSearchFailed(search_id);
     emit SearchFinished(search_id, results);
     return;
   }
@@ -63,6 +63,9 @@ ConnectedDevice::ConnectedDevice(const QUrl &url, DeviceLister *lister, const QS
                  QString("device_%1_subdirectories").arg(database_id),
                  QString("device_%1_fts").arg(database_id));
 
+  // Songs copied to the device before the duplicate key existed don't have one yet.
+  backend_->UpdateDuplicateKeysAsync();
+
   // Create the model
   model_ = new CollectionModel(backend_, app_, this);
 
@@ -23,8 +23,10 @@
 #include <libmtp.h>
 
 #include <QObject>
+#include <QHash>
 #include <QUrl>
 
+#include "core/logging.h"
 #include "core/taskmanager.h"
 #include "core/song.h"
 #include "collection/collectionbackend.h"
@@ -82,13 +84,53 @@ bool MtpLoader::TryLoad() {
     LIBMTP_destroy_track_t(track);
   }
 
-  // Need to remove all the existing songs in the database first
-  backend_->DeleteSongs(backend_->FindSongsInDirectory(1));
-
-  // Add the songs we've just loaded
-  backend_->AddOrUpdateSongs(songs);
+  UpdateCollection(songs);
 
   return true;
 
 }
 
+void MtpLoader::UpdateCollection(const SongList &device_songs) {
+
+  SongList changed_songs;
+  SongList deleted_songs;
+  DiffSongs(backend_->FindSongsInDirectory(1), device_songs, &changed_songs, &deleted_songs);
+
+  qLog(Debug) << "MTP device has" << device_songs.count() << "songs," << changed_songs.count() << "new or changed," << deleted_songs.count() << "deleted";
+
+  if (!deleted_songs.isEmpty()) backend_->DeleteSongs(deleted_songs);
+  if (!changed_songs.isEmpty()) backend_->AddOrUpdateSongs(changed_songs);
+
+}
+
+void MtpLoader::DiffSongs(const SongList &db_songs, const SongList &device_songs, SongList *changed_songs, SongList *deleted_songs) {
+
+  QHash<QUrl, Song> old_songs;
+  for (const Song &song : db_songs) {
+    old_songs.insert(song.url(), song);
+  }
+
+  for (const Song &device_song : device_songs) {
+    QHash<QUrl, Song>::iterator it = old_songs.find(device_song.url());
+    if (it == old_songs.end()) {
+      changed_songs->append(device_song);
+      continue;
+    }
+
+    const Song &old_song = it.value();
+    if (old_song.mtime() != device_song.mtime() || old_song.filesize() != device_song.filesize()) {
+      // Update the existing row instead of adding a new one
+      Song song(device_song);
+      song.set_id(old_song.id());
+      changed_songs->append(song);
+    }
+    old_songs.erase(it);
+  }
+
+  // Whatever is left isn't on the device any more
+  for (const Song &song : old_songs.values()) {
+    deleted_songs->append(song);
+  }
+
+}
+
@@ -31,6 +31,8 @@
 #include <QString>
 #include <QUrl>
 
+#include "core/song.h"
+
 class TaskManager;
 class CollectionBackend;
 class ConnectedDevice;
@@ -45,6 +47,10 @@ class MtpLoader : public QObject {
 
   bool Init();
 
+  // Works out which songs in the database need to change to match the songs on the device.
+  // Songs are matched by URL, which contains the device's object ID, and are only updated if the modification time or size changed.
+  static void DiffSongs(const SongList &db_songs, const SongList &device_songs, SongList *changed_songs, SongList *deleted_songs);
+
  public slots:
   void LoadDatabase();
 
@@ -55,6 +61,8 @@ class MtpLoader : public QObject {
 
  private:
   bool TryLoad();
+  // Brings the database up to date with the given list of songs on the device, only touching the rows that changed.
+  void UpdateCollection(const SongList &device_songs);
 
  private:
   std::shared_ptr<ConnectedDevice> device_;
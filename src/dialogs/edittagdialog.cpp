@@ -25,17 +25,17 @@
 #include <limits>
 
 #include <QtGlobal>
-#include <QtConcurrentRun>
-#include <QFuture>
 #include <QObject>
 #include <QWidget>
 #include <QDialog>
 #include <QItemSelectionModel>
 #include <QAbstractItemModel>
 #include <QDir>
+#include <QFileInfo>
 #include <QAction>
 #include <QDateTime>
 #include <QList>
+#include <QMap>
 #include <QVariant>
 #include <QString>
 #include <QStringBuilder>
@@ -74,6 +74,7 @@
 #include "widgets/busyindicator.h"
 #include "widgets/lineedit.h"
 #include "collection/collectionbackend.h"
+#include "settings/collectionsettingspage.h"
 #include "playlist/playlist.h"
 #include "playlist/playlistdelegates.h"
 #if defined(HAVE_GSTREAMER) && defined(HAVE_CHROMAPRINT)
@@ -88,6 +89,9 @@
 
 const char *EditTagDialog::kHintText = QT_TR_NOOP("(different across multiple songs)");
 const char *EditTagDialog::kSettingsGroup = "EditTagDialog";
+const int EditTagDialog::kMaxPendingTagReads = 20;
+const int EditTagDialog::kMaxPendingSaves = 4;
+const int EditTagDialog::kSaveBatchSize = 50;
 
 EditTagDialog::EditTagDialog(Application *app, QWidget *parent)
     : QDialog(parent),
@@ -97,14 +101,23 @@ EditTagDialog::EditTagDialog(Application *app, QWidget *parent)
       loading_(false),
       ignore_edits_(false),
 #if defined(HAVE_GSTREAMER) && defined(HAVE_CHROMAPRINT)
-      tag_fetcher_(new TagFetcher(this)),
+      tag_fetcher_(new TagFetcher(app, this)),
 #endif
       cover_art_id_(0),
       cover_art_is_set_(false),
       results_dialog_(new TrackSelectionDialog(this)),
+      load_id_(0),
+      skip_unchanged_(false),
+      songs_total_(0),
+      next_load_index_(0),
+      next_add_index_(0),
+      pending_tag_reads_(0),
+      saves_total_(0),
+      saves_finished_(0),
       pending_(0)
   {
 
+  cover_options_.keep_original_image_ = true;
   cover_options_.default_output_image_ = AlbumCoverLoader::ScaleAndPad(cover_options_, QImage(":/pictures/cdcase.png"));
 
   connect(app_->album_cover_loader(), SIGNAL(ImageLoaded(quint64,QImage,QImage)), SLOT(ArtLoaded(quint64,QImage,QImage)));
@@ -253,46 +266,107 @@ bool EditTagDialog::SetLoading(const QString &message) {
 
 }
 
-QList<EditTagDialog::Data> EditTagDialog::LoadData(const SongList &songs) const {
+void EditTagDialog::SetSongs(const SongList &s, const PlaylistItemList &items) {
+
+  // Show the loading indicator
+  if (!SetLoading(tr("Loading tracks") + "...")) return;
 
-  QList<Data> ret;
+  data_.clear();
+  playlist_items_ = items;
+  ui_->song_list->clear();
 
-  for (const Song &song : songs) {
-    if (song.IsEditable()) {
-      // Try reloading the tags from file
-      Song copy(song);
-      TagReaderClient::Instance()->ReadFileBlocking(copy.url().toLocalFile(), &copy);
+  QSettings settings;
+  settings.beginGroup(CollectionSettingsPage::kSettingsGroup);
+  skip_unchanged_ = settings.value("edittag_skip_unchanged", false).toBool();
+  settings.endGroup();
 
-      if (copy.is_valid()) {
-        copy.MergeUserSetData(song);
-        ret << Data(copy);
-      }
+  // Reload tags from the files, spread over the tag reader workers
+  ++load_id_;
+  songs_to_load_ = s;
+  songs_loaded_.clear();
+  songs_total_ = s.count();
+  next_load_index_ = 0;
+  next_add_index_ = 0;
+  pending_tag_reads_ = 0;
+
+  ReadMoreTags();
+
+}
+
+void EditTagDialog::ReadMoreTags() {
+
+  while (!songs_to_load_.isEmpty() && pending_tag_reads_ < kMaxPendingTagReads) {
+    const Song song = songs_to_load_.takeFirst();
+    const int index = next_load_index_++;
+
+    if (!song.IsEditable()) {
+      songs_loaded_.insert(index, Song());
+      continue;
+    }
+
+    // The collection already has the tags of files that were not modified since they were scanned
+    if (skip_unchanged_ && song.id() != -1 && song.mtime() > 0 && QFileInfo(song.url().toLocalFile()).lastModified().toTime_t() == song.mtime()) {
+      songs_loaded_.insert(index, song);
+      continue;
     }
+
+    TagReaderReply *reply = TagReaderClient::Instance()->ReadFile(song.url().toLocalFile());
+    NewClosure(reply, SIGNAL(Finished(bool)), this, SLOT(TagsRead(TagReaderReply*, int, int, Song)), reply, load_id_, index, song);
+    ++pending_tag_reads_;
   }
 
-  return ret;
+  AddLoadedSongs();
+
 }
 
-void EditTagDialog::SetSongs(const SongList &s, const PlaylistItemList &items) {
+void EditTagDialog::TagsRead(TagReaderReply *reply, const int load_id, const int index, const Song song) {
 
-  // Show the loading indicator
-  if (!SetLoading(tr("Loading tracks") + "...")) return;
+  reply->deleteLater();
 
-  data_.clear();
-  playlist_items_ = items;
-  ui_->song_list->clear();
+  // SetSongs was called again
+  if (load_id != load_id_) return;
+
+  --pending_tag_reads_;
 
-  // Reload tags in the background
-  QFuture<QList<Data>> future = QtConcurrent::run(this, &EditTagDialog::LoadData, s);
-  NewClosure(future, this, SLOT(SetSongsFinished(QFuture<QList<EditTagDialog::Data>>)), future);
+  Song copy(song);
+  if (reply->is_successful()) {
+    copy.InitFromProtobuf(reply->message().read_file_response().metadata());
+  }
+
+  if (copy.is_valid()) {
+    copy.MergeUserSetData(song);
+    songs_loaded_.insert(index, copy);
+  }
+  else {
+    songs_loaded_.insert(index, Song());
+  }
+
+  ReadMoreTags();
+
+}
+
+void EditTagDialog::AddLoadedSongs() {
+
+  while (songs_loaded_.contains(next_add_index_)) {
+    const Song song = songs_loaded_.take(next_add_index_++);
+    if (!song.is_valid()) continue;
+    data_ << Data(song);
+    ui_->song_list->addItem(song.basefilename());
+  }
+
+  if (next_add_index_ < songs_total_) {
+    ui_->loading_label->set_text(tr("Loading tracks %1/%2").arg(next_add_index_).arg(songs_total_) + "...");
+    return;
+  }
+
+  SetSongsFinished();
 
 }
 
-void EditTagDialog::SetSongsFinished(QFuture<QList<Data>> future) {
+void EditTagDialog::SetSongsFinished() {
 
   if (!SetLoading(QString())) return;
 
-  data_ = future.result();
   if (data_.count() == 0) {
     // If there were no valid songs, disable everything
     ui_->song_list->setEnabled(false);
@@ -306,11 +380,6 @@ void EditTagDialog::SetSongsFinished(QFuture<QList<Data>> future) {
     return;
   }
 
-  // Add the filenames to the list
-  for (const Data &data : data_) {
-    ui_->song_list->addItem(data.current_.basefilename());
-  }
-
   // Select all
   ui_->song_list->setCurrentRow(0);
   ui_->song_list->selectAll();
@@ -730,17 +799,36 @@ void EditTagDialog::ButtonClicked(QAbstractButton *button) {
 
 void EditTagDialog::SaveData(const QList<Data> &data) {
 
-  for (int i = 0; i < data.count(); ++i) {
-    const Data &ref = data[i];
+  songs_to_save_.clear();
+  songs_saved_.clear();
+  for (const Data &ref : data) {
     if (ref.current_.IsMetadataEqual(ref.original_)) continue;
+    songs_to_save_ << ref.current_;
+  }
+  saves_total_ = songs_to_save_.count();
+  saves_finished_ = 0;
 
-    pending_++;
-    TagReaderReply *reply = TagReaderClient::Instance()->SaveFile(ref.current_.url().toLocalFile(), ref.current_);
-    NewClosure(reply, SIGNAL(Finished(bool)), this, SLOT(SongSaveComplete(TagReaderReply*, QString, Song)), reply, ref.current_.url().toLocalFile(), ref.current_);
+  SaveMoreSongs();
 
+}
+
+void EditTagDialog::SaveMoreSongs() {
+
+  // Save the songs in batches, a few batches at a time so they are spread over the tag reader workers.
+  while (!songs_to_save_.isEmpty() && pending_ < kMaxPendingSaves) {
+    const SongList songs = songs_to_save_.mid(0, kSaveBatchSize);
+    songs_to_save_.erase(songs_to_save_.begin(), songs_to_save_.begin() + songs.count());
+    pending_++;
+    TagReaderReply *reply = TagReaderClient::Instance()->SaveFiles(songs);
+    NewClosure(reply, SIGNAL(Finished(bool)), this, SLOT(SongsSaveComplete(TagReaderReply*, SongList)), reply, songs);
   }
 
-  if (pending_ <= 0) AcceptFinished();
+  if (pending_ <= 0) {
+    AcceptFinished();
+  }
+  else if (saves_total_ > 1) {
+    ui_->loading_label->set_text(tr("Saving tracks %1/%2").arg(saves_finished_).arg(saves_total_) + "...");
+  }
 
 }
 
@@ -754,8 +842,17 @@ void EditTagDialog::accept() {
 }
 
 void EditTagDialog::AcceptFinished() {
+
   if (!SetLoading(QString())) return;
+
+  // Update the collection once for all saved songs
+  if (!songs_saved_.isEmpty()) {
+    app_->collection_backend()->AddOrUpdateSongs(songs_saved_);
+    songs_saved_.clear();
+  }
+
   QDialog::accept();
+
 }
 
 bool EditTagDialog::eventFilter(QObject *o, QEvent *e) {
@@ -892,22 +989,25 @@ void EditTagDialog::FetchTagSongChosen(const Song &original_song, const Song &ne
 }
 #endif
 
-void EditTagDialog::SongSaveComplete(TagReaderReply *reply, const QString filename, const Song song) {
+void EditTagDialog::SongsSaveComplete(TagReaderReply *reply, const SongList songs) {
 
   reply->deleteLater();
 
   pending_--;
-
-  if (!reply->message().save_file_response().success()) {
-    QString message = tr("An error occurred writing metadata to '%1'").arg(filename);
-    emit Error(message);
-  }
-  else if (song.directory_id() != -1) {
-    SongList songs;
-    songs << song;
-    app_->collection_backend()->AddOrUpdateSongs(songs);
+  saves_finished_ += songs.count();
+
+  const pb::tagreader::SaveFilesResponse &response = reply->message().save_files_response();
+  for (int i = 0; i < songs.count(); ++i) {
+    const Song &song = songs[i];
+    if (!reply->is_successful() || i >= response.success_size() || !response.success(i)) {
+      QString message = tr("An error occurred writing metadata to '%1'").arg(song.url().toLocalFile());
+      emit Error(message);
+    }
+    else if (song.directory_id() != -1) {
+      songs_saved_ << song;
+    }
   }
 
-  if (pending_ <= 0) AcceptFinished();
+  SaveMoreSongs();
 
 }
@@ -29,9 +29,9 @@
 #include <QObject>
 #include <QDialog>
 #include <QWidget>
-#include <QFuture>
 #include <QModelIndexList>
 #include <QList>
+#include <QMap>
 #include <QVariant>
 #include <QString>
 #include <QImage>
@@ -67,6 +67,9 @@ class EditTagDialog : public QDialog {
 
   static const char *kHintText;
   static const char *kSettingsGroup;
+  static const int kMaxPendingTagReads;
+  static const int kMaxPendingSaves;
+  static const int kSaveBatchSize;
 
   void SetSongs(const SongList &songs, const PlaylistItemList &items = PlaylistItemList());
 
@@ -101,7 +104,7 @@ class EditTagDialog : public QDialog {
   };
 
  private slots:
-  void SetSongsFinished(QFuture<QList<EditTagDialog::Data>> future);
+  void TagsRead(TagReaderReply *reply, const int load_id, const int index, const Song song);
   void AcceptFinished();
 
   void SelectionChanged();
@@ -126,7 +129,7 @@ class EditTagDialog : public QDialog {
   void PreviousSong();
   void NextSong();
 
-  void SongSaveComplete(TagReaderReply *reply, const QString filename, const Song song);
+  void SongsSaveComplete(TagReaderReply *reply, const SongList songs);
 
  private:
   struct FieldData {
@@ -157,9 +160,11 @@ class EditTagDialog : public QDialog {
   bool SetLoading(const QString &message);
   void SetSongListVisibility(bool visible);
 
-  // Called by QtConcurrentRun
-  QList<Data> LoadData(const SongList &songs) const;
+  void ReadMoreTags();
+  void AddLoadedSongs();
+  void SetSongsFinished();
   void SaveData(const QList<Data> &data);
+  void SaveMoreSongs();
 
  private:
   Ui_EditTagDialog *ui_;
@@ -193,6 +198,20 @@ class EditTagDialog : public QDialog {
 
   TrackSelectionDialog *results_dialog_;
 
+  // Songs are loaded in parallel, but added to the list in their original order.
+  int load_id_;
+  bool skip_unchanged_;
+  SongList songs_to_load_;
+  QMap<int, Song> songs_loaded_;
+  int songs_total_;
+  int next_load_index_;
+  int next_add_index_;
+  int pending_tag_reads_;
+
+  SongList songs_to_save_;
+  SongList songs_saved_;
+  int saves_total_;
+  int saves_finished_;
   int pending_;
 };
 
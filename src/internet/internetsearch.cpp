@@ -62,20 +62,23 @@ InternetSearch::InternetSearch(Application *app, Song::Source source, QObject *p
       source_(source),
       service_(app->internet_services()->ServiceBySource(source)),
       searches_next_id_(1),
-      art_searches_next_id_(1) {
+      art_searches_next_id_(1),
+      results_valid_(false),
+      results_type_(SearchType_Artists) {
 
   cover_loader_options_.desired_height_ = kArtHeight;
   cover_loader_options_.pad_output_image_ = true;
   cover_loader_options_.scale_output_image_ = true;
 
+  connect(app_, SIGNAL(SettingsChanged()), SLOT(ReloadSettings()));
   connect(app_->album_cover_loader(), SIGNAL(ImageLoaded(quint64, QImage)), SLOT(AlbumArtLoaded(quint64, QImage)));
-  connect(this, SIGNAL(SearchAsyncSig(int, QString, SearchType)), this, SLOT(DoSearchAsync(int, QString, SearchType)));
+  connect(this, SIGNAL(SearchAsyncSig(int, QString, SearchType, bool)), this, SLOT(DoSearchAsync(int, QString, SearchType, bool)));
   connect(this, SIGNAL(ResultsAvailable(int, InternetSearch::ResultList)), SLOT(ResultsAvailableSlot(int, InternetSearch::ResultList)));
   connect(this, SIGNAL(ArtLoaded(int, QImage)), SLOT(ArtLoadedSlot(int, QImage)));
   connect(service_, SIGNAL(UpdateStatus(QString)), SLOT(UpdateStatusSlot(QString)));
   connect(service_, SIGNAL(ProgressSetMaximum(int)), SLOT(ProgressSetMaximumSlot(int)));
   connect(service_, SIGNAL(UpdateProgress(int)), SLOT(UpdateProgressSlot(int)));
-  connect(service_, SIGNAL(SearchResults(int, SongList)), SLOT(SearchDone(int, SongList)));
+  connect(service_, SIGNAL(SearchResults(int, SongList, bool)), SLOT(SearchDone(int, SongList, bool)));
   connect(service_, SIGNAL(SearchError(int, QString)), SLOT(HandleError(int, QString)));
 
 }
@@ -113,24 +116,68 @@ bool InternetSearch::Matches(const QStringList &tokens, const QString &string) {
 
 }
 
-int InternetSearch::SearchAsync(const QString &query, SearchType type) {
+int InternetSearch::SearchAsync(const QString &query, SearchType type, bool refine) {
 
   const int id = searches_next_id_++;
 
-  emit SearchAsyncSig(id, query, type);
+  emit SearchAsyncSig(id, query, type, refine);
 
   return id;
 
 }
 
+bool InternetSearch::CanRefine(const QString &query, SearchType type) const {
+
+  if (!results_valid_ || type != results_type_) return false;
+
+  // Every token of the last query has to be part of a token in the new query, otherwise the new query could match songs the last search did not return.
+  const QStringList tokens = TokenizeQuery(query);
+  for (const QString &results_token : results_tokens_) {
+    bool found = false;
+    for (const QString &token : tokens) {
+      if (token.contains(results_token, Qt::CaseInsensitive)) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) return false;
+  }
+
+  return true;
+
+}
+
 void InternetSearch::SearchAsync(int id, const QString &query, SearchType type) {
 
   const int service_id = service_->Search(query, type);
-  pending_searches_[service_id] = PendingState(id, TokenizeQuery(query));
+  pending_searches_[service_id] = PendingState(id, TokenizeQuery(query), type);
+
+}
+
+void InternetSearch::RefineResults(int id, const QString &query) {
+
+  const QStringList tokens = TokenizeQuery(query);
+
+  ResultList ret;
+  for (const Result &result : results_) {
+    const Song &song = result.metadata_;
+    if (Matches(tokens, song.artist() + " " + song.albumartist() + " " + song.album() + " " + song.title())) {
+      ret << result;
+    }
+  }
+
+  emit ResultsRefined(id, ret);
+  emit SearchFinished(id);
 
 }
 
-void InternetSearch::DoSearchAsync(int id, const QString &query, SearchType type) {
+void InternetSearch::DoSearchAsync(int id, const QString &query, SearchType type, bool refine) {
+
+  // The caller decided whether this is a refinement and has already set up its model for it, so don't decide again here.
+  if (refine) {
+    RefineResults(id, query);
+    return;
+  }
 
   int timer_id = startTimer(kDelayedSearchTimeoutMs);
   delayed_searches_[timer_id].id_ = id;
@@ -139,9 +186,10 @@ void InternetSearch::DoSearchAsync(int id, const QString &query, SearchType type
 
 }
 
-void InternetSearch::SearchDone(int service_id, const SongList &songs) {
+void InternetSearch::SearchDone(int service_id, const SongList &songs, bool truncated) {
 
   // Map back to the original id.
+  const bool pending = pending_searches_.contains(service_id);
   const PendingState state = pending_searches_.take(service_id);
   const int search_id = state.orig_id_;
 
@@ -149,9 +197,22 @@ void InternetSearch::SearchDone(int service_id, const SongList &songs) {
   for (const Song &song : songs) {
     Result result;
     result.metadata_ = song;
+    result.pixmap_cache_key_ = PixmapCacheKey(result);
     ret << result;
   }
 
+  // Keep the results for refining this search, unless they are or will be truncated.
+  results_valid_ = pending && !truncated && ret.count() <= kMaxResultsPerEmission;
+  if (results_valid_) {
+    results_type_ = state.type_;
+    results_tokens_ = state.tokens_;
+    results_ = ret;
+  }
+  else {
+    results_tokens_.clear();
+    results_.clear();
+  }
+
   emit ResultsAvailable(search_id, ret);
   MaybeSearchFinished(search_id);
 
@@ -315,6 +376,15 @@ MimeData *InternetSearch::LoadTracks(const ResultList &results) {
 
 }
 
+void InternetSearch::ReloadSettings() {
+
+  // The service settings might affect the results, don't refine results from before.
+  results_valid_ = false;
+  results_tokens_.clear();
+  results_.clear();
+
+}
+
 void InternetSearch::UpdateStatusSlot(QString text) {
   emit UpdateStatus(text);
 }
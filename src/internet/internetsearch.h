@@ -64,7 +64,10 @@ class InternetSearch : public QObject {
   Song::Source source() const { return source_; }
   InternetService *service() const { return service_; }
 
-  int SearchAsync(const QString &query, SearchType type);
+  // If refine is set the results are filtered from the last search instead of searching the service again, see CanRefine().
+  int SearchAsync(const QString &query, SearchType type, bool refine = false);
+  // True if the results for query can be filtered from the results of the last search instead of searching the service again.
+  bool CanRefine(const QString &query, SearchType type) const;
   int LoadArtAsync(const InternetSearch::Result &result);
 
   void CancelSearch(int id);
@@ -75,9 +78,10 @@ class InternetSearch : public QObject {
   MimeData *LoadTracks(const ResultList &results);
 
  signals:
-  void SearchAsyncSig(int id, const QString &query, SearchType type);
+  void SearchAsyncSig(int id, const QString &query, SearchType type, bool refine);
   void ResultsAvailable(int id, const InternetSearch::ResultList &results);
   void AddResults(int id, const InternetSearch::ResultList &results);
+  void ResultsRefined(int id, const InternetSearch::ResultList &results);
   void SearchError(const int id, const QString error);
   void SearchFinished(int id);
   void UpdateStatus(QString text);
@@ -90,11 +94,12 @@ class InternetSearch : public QObject {
  protected:
 
   struct PendingState {
-    PendingState() : orig_id_(-1) {}
-    PendingState(int orig_id, QStringList tokens)
-        : orig_id_(orig_id), tokens_(tokens) {}
+    PendingState() : orig_id_(-1), type_(SearchType_Artists) {}
+    PendingState(int orig_id, QStringList tokens, SearchType type = SearchType_Artists)
+        : orig_id_(orig_id), tokens_(tokens), type_(type) {}
     int orig_id_;
     QStringList tokens_;
+    SearchType type_;
 
     bool operator<(const PendingState &b) const {
       return orig_id_ < b.orig_id_;
@@ -113,8 +118,8 @@ class InternetSearch : public QObject {
   static bool Matches(const QStringList &tokens, const QString &string);
 
  private slots:
-  void DoSearchAsync(int id, const QString &query, SearchType type);
-  void SearchDone(int id, const SongList &songs);
+  void DoSearchAsync(int id, const QString &query, SearchType type, bool refine);
+  void SearchDone(int id, const SongList &songs, bool truncated);
   void HandleError(const int id, const QString error);
   void ResultsAvailableSlot(int id, InternetSearch::ResultList results);
 
@@ -125,8 +130,11 @@ class InternetSearch : public QObject {
   void ProgressSetMaximumSlot(int progress);
   void UpdateProgressSlot(int max);
 
+  void ReloadSettings();
+
  private:
   void SearchAsync(int id, const QString &query, SearchType type);
+  void RefineResults(int id, const QString &query);
   void HandleLoadedArt(int id, const QImage &image);
   bool FindCachedPixmap(const InternetSearch::Result &result, QPixmap *pixmap) const;
   QString PixmapCacheKey(const InternetSearch::Result &result) const;
@@ -157,6 +165,13 @@ class InternetSearch : public QObject {
 
   QMap<int, PendingState> pending_searches_;
 
+  // Results of the last completed search, used to answer refinements of that search locally.
+  // Only kept when the service returned every match, not when its search limits cut off the results.
+  bool results_valid_;
+  SearchType results_type_;
+  QStringList results_tokens_;
+  ResultList results_;
+
 };
 
 Q_DECLARE_METATYPE(InternetSearch::Result)
@@ -77,6 +77,64 @@ void InternetSearchModel::AddResults(const InternetSearch::ResultList &results)
 
 }
 
+void InternetSearchModel::SetResults(const InternetSearch::ResultList &results) {
+
+  QSet<QString> keep;
+  for (const InternetSearch::Result &result : results) {
+    keep.insert(result.metadata_.url().toString());
+  }
+
+  QSet<QString> kept;
+  QSet<QStandardItem*> removed_containers;
+  RemoveResults(invisibleRootItem(), keep, &kept, &removed_containers);
+
+  if (!removed_containers.isEmpty()) {
+    for (QMap<ContainerKey, QStandardItem*>::iterator it = containers_.begin(); it != containers_.end();) {
+      if (removed_containers.contains(it.value())) it = containers_.erase(it);
+      else ++it;
+    }
+  }
+
+  InternetSearch::ResultList added;
+  for (const InternetSearch::Result &result : results) {
+    if (!kept.contains(result.metadata_.url().toString())) added << result;
+  }
+  AddResults(added);
+
+}
+
+void InternetSearchModel::RemoveResults(QStandardItem *parent, const QSet<QString> &keep, QSet<QString> *kept, QSet<QStandardItem*> *removed_containers) {
+
+  // Walk backwards and remove consecutive rows together, so the rows before are not moved.
+  int remove_end = -1;
+  for (int row = parent->rowCount() - 1; row >= 0; --row) {
+    QStandardItem *item = parent->child(row);
+    bool remove = false;
+    QVariant result = item->data(Role_Result);
+    if (result.isValid()) {
+      const QString key = result.value<InternetSearch::Result>().metadata_.url().toString();
+      if (keep.contains(key)) kept->insert(key);
+      else remove = true;
+    }
+    else {
+      RemoveResults(item, keep, kept, removed_containers);
+      if (item->rowCount() == 0) {
+        removed_containers->insert(item);
+        remove = true;
+      }
+    }
+    if (remove) {
+      if (remove_end == -1) remove_end = row;
+    }
+    else if (remove_end != -1) {
+      parent->removeRows(row + 1, remove_end - row);
+      remove_end = -1;
+    }
+  }
+  if (remove_end != -1) parent->removeRows(0, remove_end + 1);
+
+}
+
 QStandardItem *InternetSearchModel::BuildContainers(const Song &s, QStandardItem *parent, ContainerKey *key, int level) {
 
   if (level >= 3) {
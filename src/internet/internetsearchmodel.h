@@ -71,8 +71,11 @@ class InternetSearchModel : public QStandardItemModel {
 
  public slots:
   void AddResults(const InternetSearch::ResultList &results);
+  // Replaces the results, only rows that are not in both the old and new results are removed or added.
+  void SetResults(const InternetSearch::ResultList &results);
 
  private:
+  void RemoveResults(QStandardItem *parent, const QSet<QString> &keep, QSet<QString> *kept, QSet<QStandardItem*> *removed_containers);
   QStandardItem *BuildContainers(const Song &metadata, QStandardItem *parent, ContainerKey *key, int level = 0);
   void GetChildResults(const QStandardItem *item, InternetSearch::ResultList *results, QSet<const QStandardItem*> *visited) const;
 
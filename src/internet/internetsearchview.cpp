@@ -157,6 +157,7 @@ InternetSearchView::InternetSearchView(Application *app, InternetSearch *engine,
   connect(engine_, SIGNAL(UpdateProgress(int)), SLOT(UpdateProgress(int)), Qt::QueuedConnection);
 
   connect(engine_, SIGNAL(AddResults(int, InternetSearch::ResultList)), SLOT(AddResults(int, InternetSearch::ResultList)), Qt::QueuedConnection);
+  connect(engine_, SIGNAL(ResultsRefined(int, InternetSearch::ResultList)), SLOT(RefineResults(int, InternetSearch::ResultList)), Qt::QueuedConnection);
   connect(engine_, SIGNAL(SearchError(int, QString)), SLOT(SearchError(int, QString)), Qt::QueuedConnection);
   connect(engine_, SIGNAL(ArtLoaded(int, QPixmap)), SLOT(ArtLoaded(int, QPixmap)), Qt::QueuedConnection);
 
@@ -219,11 +220,15 @@ void InternetSearchView::TextEdited(const QString &text) {
 
   error_ = false;
 
-  // Add results to the back model, switch models after some delay.
-  back_model_->Clear();
-  current_model_ = back_model_;
-  current_proxy_ = back_proxy_;
-  swap_models_timer_->start();
+  // Refinements of the last search are filtered by the engine and updated in the current model.
+  // Otherwise add results to the back model, switch models after some delay.
+  const bool refine = !trimmed.isEmpty() && engine_->CanRefine(trimmed, search_type_);
+  if (!refine) {
+    back_model_->Clear();
+    current_model_ = back_model_;
+    current_proxy_ = back_proxy_;
+    swap_models_timer_->start();
+  }
 
   // Cancel the last search (if any) and start the new one.
   engine_->CancelSearch(last_search_id_);
@@ -237,7 +242,7 @@ void InternetSearchView::TextEdited(const QString &text) {
   }
   else {
     ui_->progressbar->reset();
-    last_search_id_ = engine_->SearchAsync(trimmed, search_type_);
+    last_search_id_ = engine_->SearchAsync(trimmed, search_type_, refine);
   }
 
 }
@@ -251,6 +256,21 @@ void InternetSearchView::AddResults(int id, const InternetSearch::ResultList &re
   current_model_->AddResults(results);
 }
 
+void InternetSearchView::RefineResults(int id, const InternetSearch::ResultList &results) {
+
+  if (id != last_search_id_) return;
+
+  ui_->label_status->clear();
+  ui_->progressbar->reset();
+  ui_->progressbar->hide();
+  current_model_->SetResults(results);
+
+  if (!swap_models_timer_->isActive()) {
+    ui_->results_stack->setCurrentWidget(ui_->results_page);
+  }
+
+}
+
 void InternetSearchView::SearchError(const int id, const QString error) {
   error_ = true;
   ui_->label_helptext->setText(error);
@@ -324,7 +344,10 @@ void InternetSearchView::LazyLoadArt(const QModelIndex &proxy_index) {
 void InternetSearchView::ArtLoaded(int id, const QPixmap &pixmap) {
 
   if (!art_requests_.contains(id)) return;
-  QModelIndex index = art_requests_.take(id);
+  QPersistentModelIndex index = art_requests_.take(id);
+
+  // The row might have been removed by a refined search.
+  if (!index.isValid()) return;
 
   if (!pixmap.isNull()) {
     front_model_->itemFromIndex(index)->setData(pixmap, Qt::DecorationRole);
@@ -28,6 +28,7 @@
 #include <QObject>
 #include <QTimer>
 #include <QMap>
+#include <QPersistentModelIndex>
 #include <QList>
 #include <QString>
 #include <QIcon>
@@ -80,6 +81,7 @@ signals:
   void ProgressSetMaximum(int progress);
   void UpdateProgress(int max);
   void AddResults(int id, const InternetSearch::ResultList &results);
+  void RefineResults(int id, const InternetSearch::ResultList &results);
   void SearchError(const int id, const QString error);
   void ArtLoaded(int id, const QPixmap &pixmap);
 
@@ -129,7 +131,7 @@ signals:
   QSortFilterProxyModel *back_proxy_;
   QSortFilterProxyModel *current_proxy_;
 
-  QMap<int, QModelIndex> art_requests_;
+  QMap<int, QPersistentModelIndex> art_requests_;
 
   QTimer *swap_models_timer_;
 
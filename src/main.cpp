@@ -89,10 +89,14 @@
 #include "core/application.h"
 #include "core/networkproxyfactory.h"
 #include "core/scangiomodulepath.h"
+#include "core/startuptrace.h"
 #ifdef HAVE_TRANSLATIONS
 #  include "core/potranslator.h"
 #endif
 #include "settings/behavioursettingspage.h"
+#ifdef HAVE_GSTREAMER
+#  include "transcoder/batchtranscoder.h"
+#endif
 
 #include "widgets/osd.h"
 
@@ -140,6 +144,15 @@ int main(int argc, char* argv[]) {
     // Parse commandline options - need to do this before starting the full QApplication so it works without an X server
     if (!options.Parse()) return 1;
     logging::SetLevels(options.log_levels());
+    if (!options.startup_trace_file().isEmpty()) StartupTrace::Enable(options.startup_trace_file());
+#ifdef HAVE_GSTREAMER
+    // Batch transcoding runs on its own, without a user interface and regardless of another instance running
+    if (options.transcode()) {
+      BatchTranscoder batch_transcoder(options);
+      if (!batch_transcoder.Start()) return BatchTranscoder::Exit_InvalidArguments;
+      return core_app.exec();
+    }
+#endif
     if (core_app.isSecondary()) {
       if (options.is_empty()) {
         qLog(Info) << "Strawberry is already running - activating existing window (1)";
@@ -212,6 +225,8 @@ int main(int argc, char* argv[]) {
   }
 #endif
 
+  qint64 startup_usec = StartupTrace::ElapsedUsec();
+
   // Resources
   Q_INIT_RESOURCE(data);
   Q_INIT_RESOURCE(icons);
@@ -242,7 +257,11 @@ int main(int argc, char* argv[]) {
   Utilities::LoadTranslation("strawberry", QDir::currentPath(), language);
 #endif
 
+  StartupTrace::AddPhase("Resources", startup_usec, StartupTrace::ElapsedUsec() - startup_usec);
+
+  startup_usec = StartupTrace::ElapsedUsec();
   Application app;
+  StartupTrace::AddPhase("Application", startup_usec, StartupTrace::ElapsedUsec() - startup_usec);
 
   // Network proxy
   QNetworkProxyFactory::setApplicationProxyFactory(NetworkProxyFactory::Instance());
@@ -256,7 +275,9 @@ int main(int argc, char* argv[]) {
 #endif
 
   // Window
+  startup_usec = StartupTrace::ElapsedUsec();
   MainWindow w(&app, tray_icon.get(), &osd, options);
+  StartupTrace::AddPhase("Main window", startup_usec, StartupTrace::ElapsedUsec() - startup_usec);
 #ifdef Q_OS_MACOS
   mac::EnableFullScreen(w);
 #endif  // Q_OS_MACOS
@@ -268,6 +289,9 @@ int main(int argc, char* argv[]) {
 #endif
   QObject::connect(&a, SIGNAL(receivedMessage(quint32, QByteArray)), &w, SLOT(CommandlineOptionsReceived(quint32, QByteArray)));
 
+  // Everything not needed for the first frame runs from the event loop from here on.
+  app.StartDeferredStartup();
+
   int ret = a.exec();
 
   main_exit_safe(ret);
@@ -27,11 +27,13 @@
 #include <QList>
 #include <QByteArray>
 #include <QPair>
+#include <QSet>
 #include <QVariant>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
 #include <QUrlQuery>
+#include <QTimer>
 #include <QtAlgorithms>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -46,53 +48,123 @@
 #include "core/closure.h"
 #include "core/network.h"
 #include "core/timeconstants.h"
+#include "core/utilities.h"
 
 using std::stable_sort;
 
 const char *AcoustidClient::kClientId = "0qjUoxbowg";
 const char *AcoustidClient::kUrl = "http://api.acoustid.org/v2/lookup";
 const int AcoustidClient::kDefaultTimeout = 5000;  // msec
+const int AcoustidClient::kMaxBatchSize = 20;
+const int AcoustidClient::kRequestInterval = 334;  // msec, AcoustID allows 3 requests per second
 
 AcoustidClient::AcoustidClient(QObject *parent)
     : QObject(parent),
       network_(new NetworkAccessManager(this)),
-      timeouts_(new NetworkTimeouts(kDefaultTimeout, this)) {}
+      timeouts_(new NetworkTimeouts(kDefaultTimeout, this)),
+      timer_batch_(new QTimer(this)),
+      url_(Utilities::GetEnv("STRAWBERRY_ACOUSTID_URL")) {
+
+  if (url_.isEmpty()) url_ = kUrl;
+
+  timer_batch_->setInterval(kRequestInterval);
+  connect(timer_batch_, SIGNAL(timeout()), SLOT(SendBatch()));
+
+}
 
 void AcoustidClient::SetTimeout(int msec) { timeouts_->SetTimeout(msec); }
 
 void AcoustidClient::Start(int id, const QString &fingerprint, int duration_msec) {
 
+  PendingRequest request;
+  request.id_ = id;
+  request.fingerprint_ = fingerprint;
+  request.duration_msec_ = duration_msec;
+  queue_.enqueue(request);
+
+  // Wait one interval before sending, so fingerprints finishing around the same time go out together.
+  if (!timer_batch_->isActive()) timer_batch_->start();
+
+}
+
+void AcoustidClient::SendBatch() {
+
+  if (queue_.isEmpty()) {
+    timer_batch_->stop();
+    return;
+  }
+
   typedef QPair<QString, QString> Param;
 
   QList<Param> parameters;
   parameters << Param("format", "json")
              << Param("client", kClientId)
-             << Param("duration", QString::number(duration_msec / kMsecPerSec))
-             << Param("meta", "recordingids+sources")
-             << Param("fingerprint", fingerprint);
+             << Param("meta", "recordingids+sources");
+
+  QList<int> ids;
+  if (queue_.count() == 1) {
+    const PendingRequest request = queue_.dequeue();
+    parameters << Param("duration", QString::number(request.duration_msec_ / kMsecPerSec))
+               << Param("fingerprint", request.fingerprint_);
+    ids << request.id_;
+  }
+  else {
+    for (int i = 0 ; i < kMaxBatchSize && !queue_.isEmpty() ; ++i) {
+      const PendingRequest request = queue_.dequeue();
+      parameters << Param(QString("duration.%1").arg(i), QString::number(request.duration_msec_ / kMsecPerSec))
+                 << Param(QString("fingerprint.%1").arg(i), request.fingerprint_);
+      ids << request.id_;
+    }
+  }
 
-  QUrl url(kUrl);
+  // Fingerprints are long, so they are posted as a form rather than put in the URL.
   QUrlQuery url_query;
   url_query.setQueryItems(parameters);
-  url.setQuery(url_query);
+  QUrl url(url_);
   QNetworkRequest req(url);
+  req.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
-  QNetworkReply *reply = network_->get(req);
-  NewClosure(reply, SIGNAL(finished()), this, SLOT(RequestFinished(QNetworkReply*, int)), reply, id);
-  requests_[id] = reply;
+  QNetworkReply *reply = network_->post(req, url_query.toString(QUrl::FullyEncoded).toUtf8());
+  NewClosure(reply, SIGNAL(finished()), this, SLOT(RequestFinished(QNetworkReply*, QList<int>)), reply, ids);
+  for (int id : ids) {
+    requests_[id] = reply;
+  }
 
   timeouts_->AddReply(reply);
+
+  if (queue_.isEmpty()) timer_batch_->stop();
+
 }
 
-void AcoustidClient::Cancel(int id) { delete requests_.take(id); }
+void AcoustidClient::Cancel(int id) {
+
+  for (QQueue<PendingRequest>::iterator it = queue_.begin() ; it != queue_.end() ;) {
+    if (it->id_ == id) it = queue_.erase(it);
+    else ++it;
+  }
+
+  // The reply is only aborted when no other request in its batch is still waiting for it.
+  QNetworkReply *reply = requests_.take(id);
+  if (reply && !requests_.values().contains(reply)) delete reply;
+
+}
 
 void AcoustidClient::CancelAll() {
-  qDeleteAll(requests_.values());
+
+  queue_.clear();
+  timer_batch_->stop();
+  // Requests sent in the same batch share their reply, delete each only once.
+  QSet<QNetworkReply*> replies;
+  for (QNetworkReply *reply : requests_) {
+    replies << reply;
+  }
+  qDeleteAll(replies);
   requests_.clear();
+
 }
 
 namespace {
-// Struct used when extracting results in RequestFinished
+// Struct used when extracting results in ParseRecordings
 struct IdSource {
   IdSource(const QString& id, int source)
     : id_(id), nb_sources_(source) {}
@@ -107,38 +179,56 @@ struct IdSource {
 };
 }
 
-void AcoustidClient::RequestFinished(QNetworkReply *reply, int request_id) {
+void AcoustidClient::RequestFinished(QNetworkReply *reply, const QList<int> &ids) {
 
   reply->deleteLater();
-  requests_.remove(request_id);
 
-  if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
-    emit Finished(request_id, QStringList());
-    return;
+  // Drop the IDs that were cancelled while the batch was in flight.
+  QList<int> request_ids;
+  for (int id : ids) {
+    if (requests_.value(id) == reply) {
+      requests_.remove(id);
+      request_ids << id;
+    }
   }
 
-  QJsonParseError error;
-  QJsonDocument json_document = QJsonDocument::fromJson(reply->readAll(), &error);
+  QMap<int, QStringList> results;
+
+  if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
+    QJsonParseError error;
+    QJsonDocument json_document = QJsonDocument::fromJson(reply->readAll(), &error);
+    QJsonObject json_object = json_document.object();
+
+    if (error.error == QJsonParseError::NoError && json_object["status"].toString() == "ok") {
+      if (json_object.contains("fingerprints")) {
+        // Batched lookups return the results for each fingerprint with the index it was sent with.
+        for (const QJsonValue &value : json_object["fingerprints"].toArray()) {
+          QJsonObject json_fingerprint = value.toObject();
+          const int index = json_fingerprint["index"].toVariant().toInt();
+          if (index >= 0 && index < ids.count()) {
+            results[ids[index]] = ParseRecordings(json_fingerprint["results"].toArray());
+          }
+        }
+      }
+      else if (ids.count() == 1) {
+        results[ids.first()] = ParseRecordings(json_object["results"].toArray());
+      }
+    }
+  }
 
-  if (error.error != QJsonParseError::NoError) {
-    emit Finished(request_id, QStringList());
-    return;
+  for (int id : request_ids) {
+    emit Finished(id, results.value(id));
   }
 
-  QJsonObject json_object = json_document.object();
+}
 
-  QString status = json_object["status"].toString();
-  if (status != "ok") {
-    emit Finished(request_id, QStringList());
-    return;
-  }
+QStringList AcoustidClient::ParseRecordings(const QJsonArray &json_results) {
 
   // Get the results:
   // -in a first step, gather ids and their corresponding number of sources
   // -then sort results by number of sources (the results are originally
   //  unsorted but results with more sources are likely to be more accurate)
   // -keep only the ids, as sources where useful only to sort the results
-  QJsonArray json_results = json_object["results"].toArray();
 
   // List of <id, nb of sources> pairs
   QList<IdSource> id_source_list;
@@ -158,12 +248,11 @@ void AcoustidClient::RequestFinished(QNetworkReply *reply, int request_id) {
 
   std::stable_sort(id_source_list.begin(), id_source_list.end());
 
-  QList<QString> id_list;
+  QStringList id_list;
   for (const IdSource& is : id_source_list) {
     id_list << is.id_;
   }
 
-  emit Finished(request_id, id_list);
+  return id_list;
 
 }
-
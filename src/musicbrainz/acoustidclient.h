@@ -24,12 +24,16 @@
 #include "config.h"
 
 #include <QObject>
+#include <QList>
 #include <QMap>
+#include <QQueue>
 #include <QString>
 #include <QStringList>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 
+class QTimer;
+class QJsonArray;
 class NetworkTimeouts;
 
 class AcoustidClient : public QObject {
@@ -41,6 +45,8 @@ class AcoustidClient : public QObject {
   // An MBID identifies the actual song and can be passed to Musicbrainz to get metadata.
   // You can create one AcoustidClient and make multiple requests using it.
   // IDs are provided by the caller when a request is started and included in the Finished signal - they have no meaning to AcoustidClient.
+  // Requests are queued and sent in batches, no faster than the AcoustID rate limit allows.
+  // The service URL can be pointed at a local server with the STRAWBERRY_ACOUSTID_URL environment variable.
 
  public:
   AcoustidClient(QObject *parent = nullptr);
@@ -48,7 +54,7 @@ class AcoustidClient : public QObject {
   // Network requests will be aborted after this interval.
   void SetTimeout(int msec);
 
-  // Starts a request and returns immediately.  Finished() will be emitted later with the same ID.
+  // Queues a request and returns immediately.  Finished() will be emitted later with the same ID.
   void Start(int id, const QString &fingerprint, int duration_msec);
 
   // Cancels the request with the given ID.  Finished() will never be emitted for that ID.  Does nothing if there is no request with the given ID.
@@ -61,15 +67,30 @@ signals:
   void Finished(int id, const QStringList &mbid_list);
 
  private slots:
-  void RequestFinished(QNetworkReply *reply, int id);
+  void SendBatch();
+  void RequestFinished(QNetworkReply *reply, const QList<int> &ids);
 
  private:
+  struct PendingRequest {
+    int id_;
+    QString fingerprint_;
+    int duration_msec_;
+  };
+
+  static QStringList ParseRecordings(const QJsonArray &json_results);
+
   static const char *kClientId;
   static const char *kUrl;
   static const int kDefaultTimeout;
+  static const int kMaxBatchSize;
+  static const int kRequestInterval;
 
   QNetworkAccessManager *network_;
   NetworkTimeouts *timeouts_;
+  QTimer *timer_batch_;
+  QString url_;
+  QQueue<PendingRequest> queue_;
+  // Several IDs share a reply when they were sent in the same batch.
   QMap<int, QNetworkReply*> requests_;
 };
 
@@ -72,10 +72,13 @@ GstElement *Chromaprinter::CreateElement(const QString &factory_name, GstElement
 
 }
 
-QString Chromaprinter::CreateFingerprint() {
+QString Chromaprinter::CreateFingerprint(const std::function<bool()> &cancelled) {
 
   Q_ASSERT(QThread::currentThread() != qApp->thread());
 
+  cancelled_ = cancelled;
+  if (cancelled_ && cancelled_()) return QString();
+
   buffer_.open(QIODevice::WriteOnly);
 
   GstElement *pipeline = gst_pipeline_new("pipeline");
@@ -155,6 +158,13 @@ QString Chromaprinter::CreateFingerprint() {
 
   buffer_.close();
 
+  if (cancelled_ && cancelled_()) {
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    return QString();
+  }
+
   // Generate fingerprint from recorded buffer data
   QByteArray data = buffer_.data();
 
@@ -219,6 +229,9 @@ GstFlowReturn Chromaprinter::NewBufferCallback(GstAppSink *app_sink, gpointer se
 
   Chromaprinter *me = reinterpret_cast<Chromaprinter*>(self);
 
+  // Failing the flow makes the pipeline post an error, which ends the wait for EOS.
+  if (me->cancelled_ && me->cancelled_()) return GST_FLOW_ERROR;
+
   GstSample *sample = gst_app_sink_pull_sample(app_sink);
   GstBuffer *buffer = gst_sample_get_buffer(sample);
   GstMapInfo map;
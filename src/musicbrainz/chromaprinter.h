@@ -23,6 +23,8 @@
 
 #include "config.h"
 
+#include <functional>
+
 #include <glib.h>
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
@@ -44,7 +46,8 @@ class Chromaprinter {
   // Creates a fingerprint from the song.
   // This method is blocking, so you want to call it in another thread.
   // Returns an empty string if no fingerprint could be created.
-  QString CreateFingerprint();
+  // Decoding is stopped early and no fingerprint is created once cancelled returns true.
+  QString CreateFingerprint(const std::function<bool()> &cancelled = std::function<bool()>());
 
  private:
   GstElement *CreateElement(const QString &factory_name, GstElement *bin = nullptr);
@@ -56,6 +59,7 @@ class Chromaprinter {
   QString filename_;
 
   GstElement *convert_element_;
+  std::function<bool()> cancelled_;
 
   QBuffer buffer_;
 
@@ -33,6 +33,7 @@
 #include <QRegExp>
 #include <QUrl>
 #include <QUrlQuery>
+#include <QTimer>
 #include <QtAlgorithms>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -49,42 +50,84 @@
 using std::sort;
 using std::stable_sort;
 
-const char *MusicBrainzClient::kTrackUrl = "http://musicbrainz.org/ws/2/recording/";
-const char *MusicBrainzClient::kDiscUrl = "http://musicbrainz.org/ws/2/discid/";
+const char *MusicBrainzClient::kUrl = "http://musicbrainz.org/ws/2/";
 const char *MusicBrainzClient::kDateRegex = "^[12]\\d{3}";
 const int MusicBrainzClient::kDefaultTimeout = 5000;  // msec
 const int MusicBrainzClient::kMaxRequestPerTrack = 3;
+const int MusicBrainzClient::kRequestInterval = 1000;  // msec, MusicBrainz allows one request per second
 
 MusicBrainzClient::MusicBrainzClient(QObject *parent, QNetworkAccessManager *network)
     : QObject(parent),
       network_(network ? network : new NetworkAccessManager(this)),
-      timeouts_(new NetworkTimeouts(kDefaultTimeout, this)) {}
+      timeouts_(new NetworkTimeouts(kDefaultTimeout, this)),
+      timer_requests_(new QTimer(this)),
+      url_(Utilities::GetEnv("STRAWBERRY_MUSICBRAINZ_URL")) {
 
-void MusicBrainzClient::Start(int id, const QStringList &mbid_list) {
-
-  typedef QPair<QString, QString> Param;
+  if (url_.isEmpty()) url_ = kUrl;
+  if (!url_.endsWith('/')) url_.append('/');
 
-  int request_number = 0;
-  for (const QString &mbid : mbid_list) {
-    QList<Param> parameters;
-    parameters << Param("inc", "artists+releases+media");
+  timer_requests_->setInterval(kRequestInterval);
+  connect(timer_requests_, SIGNAL(timeout()), SLOT(SendNextRequest()));
 
-    QUrl url(kTrackUrl + mbid);
-    QUrlQuery url_query;
-    url_query.setQueryItems(parameters);
-    url.setQuery(url_query);
-    QNetworkRequest req(url);
+}
 
-    QNetworkReply *reply = network_->get(req);
-    NewClosure(reply, SIGNAL(finished()), this, SLOT(RequestFinished(QNetworkReply*, int, int)), reply, id, request_number++);
-    requests_.insert(id, reply);
+void MusicBrainzClient::Start(int id, const QStringList &mbid_list) {
 
-    timeouts_->AddReply(reply);
+  int request_number = 0;
+  for (const QString &mbid : mbid_list) {
+    PendingRequest request;
+    request.id_ = id;
+    request.mbid_ = mbid;
+    request.request_number_ = request_number++;
+    queue_.enqueue(request);
 
     if (request_number >= kMaxRequestPerTrack) {
       break;
     }
   }
+
+  if (!timer_requests_->isActive()) {
+    SendNextRequest();
+    timer_requests_->start();
+  }
+
+}
+
+void MusicBrainzClient::SendNextRequest() {
+
+  if (queue_.isEmpty()) {
+    timer_requests_->stop();
+    return;
+  }
+
+  const PendingRequest request = queue_.dequeue();
+
+  typedef QPair<QString, QString> Param;
+
+  QList<Param> parameters;
+  parameters << Param("inc", "artists+releases+media");
+
+  QUrl url(url_ + "recording/" + request.mbid_);
+  QUrlQuery url_query;
+  url_query.setQueryItems(parameters);
+  url.setQuery(url_query);
+  QNetworkRequest req(url);
+
+  QNetworkReply *reply = network_->get(req);
+  NewClosure(reply, SIGNAL(finished()), this, SLOT(RequestFinished(QNetworkReply*, int, int)), reply, request.id_, request.request_number_);
+  requests_.insert(request.id_, reply);
+
+  timeouts_->AddReply(reply);
+
+}
+
+bool MusicBrainzClient::HasQueuedRequest(int id) const {
+
+  for (const PendingRequest &request : queue_) {
+    if (request.id_ == id) return true;
+  }
+  return false;
+
 }
 
 void MusicBrainzClient::StartDiscIdRequest(const QString &discid) {
@@ -94,7 +137,7 @@ void MusicBrainzClient::StartDiscIdRequest(const QString &discid) {
   QList<Param> parameters;
   parameters << Param("inc", "artists+recordings");
 
-  QUrl url(kDiscUrl + discid);
+  QUrl url(url_ + "discid/" + discid);
   QUrlQuery url_query;
   url_query.setQueryItems(parameters);
   url.setQuery(url_query);
@@ -106,11 +149,24 @@ void MusicBrainzClient::StartDiscIdRequest(const QString &discid) {
   timeouts_->AddReply(reply);
 }
 
-void MusicBrainzClient::Cancel(int id) { delete requests_.take(id); }
+void MusicBrainzClient::Cancel(int id) {
+
+  for (QQueue<PendingRequest>::iterator it = queue_.begin() ; it != queue_.end() ;) {
+    if (it->id_ == id) it = queue_.erase(it);
+    else ++it;
+  }
+  qDeleteAll(requests_.values(id));
+  requests_.remove(id);
+  pending_results_.remove(id);
+
+}
 
 void MusicBrainzClient::CancelAll() {
+  queue_.clear();
+  timer_requests_->stop();
   qDeleteAll(requests_.values());
   requests_.clear();
+  pending_results_.clear();
 }
 
 void MusicBrainzClient::DiscIdRequestFinished(const QString &discid, QNetworkReply *reply) {
@@ -220,8 +276,8 @@ void MusicBrainzClient::RequestFinished(QNetworkReply *reply, int id, int reques
     qLog(Error) << reply->readAll();
   }
 
-  // No more pending requests for this id: emit the results we have.
-  if (!requests_.contains(id)) {
+  // No more pending or queued requests for this id: emit the results we have.
+  if (!requests_.contains(id) && !HasQueuedRequest(id)) {
     // Merge the results we have
     ResultList ret;
     QList<PendingResults> result_list_list = pending_results_.take(id);
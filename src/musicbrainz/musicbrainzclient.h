@@ -31,6 +31,7 @@
 #include <QHash>
 #include <QMap>
 #include <QMultiMap>
+#include <QQueue>
 #include <QSet>
 #include <QString>
 #include <QStringList>
@@ -39,6 +40,7 @@
 #include <QXmlStreamReader>
 #include <QVector>
 
+class QTimer;
 class NetworkTimeouts;
 
 class MusicBrainzClient : public QObject {
@@ -48,6 +50,8 @@ class MusicBrainzClient : public QObject {
   // An MBID is created from a fingerprint using MusicDnsClient.
   // You can create one MusicBrainzClient and make multiple requests using it.
   // IDs are provided by the caller when a request is started and included in the Finished signal - they have no meaning to MusicBrainzClient.
+  // Recording requests are queued and sent one at a time, no faster than the MusicBrainz rate limit allows.
+  // The service URL can be pointed at a local server with the STRAWBERRY_MUSICBRAINZ_URL environment variable.
 
  public:
   // The second argument allows for specifying a custom network access manager.
@@ -90,7 +94,7 @@ class MusicBrainzClient : public QObject {
   };
   typedef QList<Result> ResultList;
 
-  // Starts a request and returns immediately.  Finished() will be emitted later with the same ID.
+  // Queues a request and returns immediately.  Finished() will be emitted later with the same ID.
   void Start(int id, const QStringList &mbid);
   void StartDiscIdRequest(const QString &discid);
 
@@ -107,6 +111,7 @@ signals:
   void Finished(const QString& artist, const QString album, const MusicBrainzClient::ResultList& result);
 
  private slots:
+  void SendNextRequest();
   // id identifies the track, and request_number means it's the 'request_number'th request for this track
   void RequestFinished(QNetworkReply* reply, int id, int request_number);
   void DiscIdRequestFinished(const QString& discid, QNetworkReply* reply);
@@ -186,16 +191,27 @@ signals:
   static Release ParseRelease(QXmlStreamReader* reader);
   static ResultList UniqueResults(const ResultList& results, UniqueResultsSortOption opt = SortResults);
 
+  struct PendingRequest {
+    int id_;
+    QString mbid_;
+    int request_number_;
+  };
+
+  bool HasQueuedRequest(int id) const;
+
 
  private:
-  static const char* kTrackUrl;
-  static const char* kDiscUrl;
+  static const char* kUrl;
   static const char* kDateRegex;
   static const int kDefaultTimeout;
   static const int kMaxRequestPerTrack;
+  static const int kRequestInterval;
 
   QNetworkAccessManager* network_;
   NetworkTimeouts* timeouts_;
+  QTimer* timer_requests_;
+  QString url_;
+  QQueue<PendingRequest> queue_;
   QMultiMap<int, QNetworkReply*> requests_;
   // Results we received so far, kept here until all the replies are finished
   QMap<int, QList<PendingResults>> pending_results_;
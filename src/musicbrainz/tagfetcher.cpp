@@ -20,32 +20,111 @@
 
 #include "config.h"
 
+#include <QtGlobal>
 #include <QObject>
-#include <QtConcurrentMap>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 #include <QFuture>
-#include <QFutureWatcher>
+#include <QMutex>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QString>
 #include <QUrl>
+#include <QVariant>
+#include <QSqlDatabase>
+#include <QSqlQuery>
 
+#include "core/application.h"
+#include "core/closure.h"
+#include "core/database.h"
 #include "core/timeconstants.h"
 #include "acoustidclient.h"
 #include "chromaprinter.h"
 #include "musicbrainzclient.h"
 #include "tagfetcher.h"
 
-TagFetcher::TagFetcher(QObject *parent)
+TagFetcher::TagFetcher(Application *app, QObject *parent)
     : QObject(parent),
-      fingerprint_watcher_(nullptr),
+      app_(app),
+      fingerprint_pool_(new QThreadPool(this)),
+      fetch_id_(0),
       acoustid_client_(new AcoustidClient(this)),
       musicbrainz_client_(new MusicBrainzClient(this)) {
 
+  // Each fingerprint runs a decoding pipeline of its own, keep them off the global pool used by everything else.
+  fingerprint_pool_->setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+
   connect(acoustid_client_, SIGNAL(Finished(int, QStringList)), SLOT(PuidsFound(int, QStringList)));
   connect(musicbrainz_client_, SIGNAL(Finished(int, MusicBrainzClient::ResultList)), SLOT(TagsFetched(int, MusicBrainzClient::ResultList)));
 
 }
 
-QString TagFetcher::GetFingerprint(const Song &song) {
-  return Chromaprinter(song.url().toLocalFile()).CreateFingerprint();
+TagFetcher::~TagFetcher() {
+
+  // Running fingerprints notice the new fetch id and stop decoding, so this only waits for them to wind down.
+  fetch_id_.ref();
+  fingerprint_pool_->clear();
+  fingerprint_pool_->waitForDone();
+
+}
+
+QString TagFetcher::GetFingerprint(Database *db, const Song &song, const QAtomicInt *current_fetch_id, const int fetch_id) {
+
+  if (current_fetch_id->load() != fetch_id) return QString();
+
+  const QString filename = song.url().toLocalFile();
+  const QFileInfo info(filename);
+  const qint64 mtime = info.lastModified().toTime_t();
+  const qint64 filesize = info.size();
+
+  QString fingerprint = CachedFingerprint(db, filename, mtime, filesize);
+  if (!fingerprint.isEmpty()) return fingerprint;
+
+  // Stop decoding when the fetch is cancelled, so cancelling or destroying the fetcher doesn't wait for whole decodes.
+  fingerprint = Chromaprinter(filename).CreateFingerprint([current_fetch_id, fetch_id]() { return current_fetch_id->load() != fetch_id; });
+  if (!fingerprint.isEmpty()) SaveFingerprint(db, filename, mtime, filesize, fingerprint);
+
+  return fingerprint;
+
+}
+
+QString TagFetcher::CachedFingerprint(Database *db, const QString &filename, const qint64 mtime, const qint64 filesize) {
+
+  if (!db) return QString();
+
+  QMutexLocker l(db->Mutex());
+  QSqlDatabase sqldb(db->Connect());
+
+  QSqlQuery q(sqldb);
+  q.prepare("SELECT fingerprint FROM fingerprints WHERE filename = :filename AND mtime = :mtime AND filesize = :filesize");
+  q.bindValue(":filename", filename);
+  q.bindValue(":mtime", mtime);
+  q.bindValue(":filesize", filesize);
+  q.exec();
+  if (db->CheckErrors(q)) return QString();
+
+  if (!q.next()) return QString();
+  return q.value(0).toString();
+
+}
+
+void TagFetcher::SaveFingerprint(Database *db, const QString &filename, const qint64 mtime, const qint64 filesize, const QString &fingerprint) {
+
+  if (!db) return;
+
+  QMutexLocker l(db->Mutex());
+  QSqlDatabase sqldb(db->Connect());
+
+  QSqlQuery q(sqldb);
+  q.prepare("INSERT OR REPLACE INTO fingerprints (filename, mtime, filesize, fingerprint) VALUES (:filename, :mtime, :filesize, :fingerprint)");
+  q.bindValue(":filename", filename);
+  q.bindValue(":mtime", mtime);
+  q.bindValue(":filesize", filesize);
+  q.bindValue(":fingerprint", fingerprint);
+  q.exec();
+  db->CheckErrors(q);
+
 }
 
 void TagFetcher::StartFetch(const SongList &songs) {
@@ -54,10 +133,11 @@ void TagFetcher::StartFetch(const SongList &songs) {
 
   songs_ = songs;
 
-  QFuture<QString> future = QtConcurrent::mapped(songs_, GetFingerprint);
-  fingerprint_watcher_ = new QFutureWatcher<QString>(this);
-  fingerprint_watcher_->setFuture(future);
-  connect(fingerprint_watcher_, SIGNAL(resultReadyAt(int)), SLOT(FingerprintFound(int)));
+  Database *db = app_ ? app_->database() : nullptr;
+  for (int i = 0 ; i < songs_.count() ; ++i) {
+    QFuture<QString> future = QtConcurrent::run(fingerprint_pool_, &TagFetcher::GetFingerprint, db, songs_[i], &fetch_id_, fetch_id_.load());
+    NewClosure(future, this, SLOT(FingerprintFound(QFuture<QString>, int, int)), future, i, fetch_id_.load());
+  }
 
   for (const Song &song : songs) {
     emit Progress(song, tr("Fingerprinting song"));
@@ -67,12 +147,8 @@ void TagFetcher::StartFetch(const SongList &songs) {
 
 void TagFetcher::Cancel() {
 
-  if (fingerprint_watcher_) {
-    fingerprint_watcher_->cancel();
-
-    delete fingerprint_watcher_;
-    fingerprint_watcher_ = nullptr;
-  }
+  // Fingerprints already running stop decoding, and their results are dropped.
+  fetch_id_.ref();
 
   acoustid_client_->CancelAll();
   musicbrainz_client_->CancelAll();
@@ -80,14 +156,13 @@ void TagFetcher::Cancel() {
 
 }
 
-void TagFetcher::FingerprintFound(int index) {
+void TagFetcher::FingerprintFound(QFuture<QString> future, int index, int fetch_id) {
 
-  QFutureWatcher<QString>* watcher = reinterpret_cast<QFutureWatcher<QString>*>(sender());
-  if (!watcher || index >= songs_.count()) {
+  if (fetch_id != fetch_id_.load() || index >= songs_.count()) {
     return;
   }
 
-  const QString fingerprint = watcher->resultAt(index);
+  const QString fingerprint = future.result();
   const Song &song = songs_[index];
 
   if (fingerprint.isEmpty()) {
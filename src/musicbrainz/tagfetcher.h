@@ -23,23 +23,31 @@
 
 #include "config.h"
 
+#include <QtGlobal>
 #include <QObject>
-#include <QFutureWatcher>
+#include <QFuture>
+#include <QAtomicInt>
 #include <QString>
 #include <QStringList>
 
 #include "core/song.h"
 #include "musicbrainzclient.h"
 
+class QThreadPool;
+
+class Application;
+class Database;
 class AcoustidClient;
 
 class TagFetcher : public QObject {
   Q_OBJECT
 
   // High level interface to Fingerprinter, AcoustidClient and MusicBrainzClient.
+  // Fingerprints are created on a pool of their own and cached in the database by filename, modification time and size.
 
  public:
-  TagFetcher(QObject *parent = nullptr);
+  TagFetcher(Application *app, QObject *parent = nullptr);
+  ~TagFetcher();
 
   void StartFetch(const SongList &songs);
 
@@ -51,14 +59,19 @@ signals:
   void ResultAvailable(const Song &original_song, const SongList &songs_guessed);
 
  private slots:
-  void FingerprintFound(int index);
+  void FingerprintFound(QFuture<QString> future, int index, int fetch_id);
   void PuidsFound(int index, const QStringList &puid_list);
   void TagsFetched(int index, const MusicBrainzClient::ResultList &result);
 
  private:
-  static QString GetFingerprint(const Song &song);
-
-  QFutureWatcher<QString> *fingerprint_watcher_;
+  static QString GetFingerprint(Database *db, const Song &song, const QAtomicInt *current_fetch_id, const int fetch_id);
+  static QString CachedFingerprint(Database *db, const QString &filename, const qint64 mtime, const qint64 filesize);
+  static void SaveFingerprint(Database *db, const QString &filename, const qint64 mtime, const qint64 filesize, const QString &fingerprint);
+
+  Application *app_;
+  QThreadPool *fingerprint_pool_;
+  // Bumped by Cancel(), so fingerprints queued by an earlier fetch are skipped and those already running are ignored.
+  QAtomicInt fetch_id_;
   AcoustidClient *acoustid_client_;
   MusicBrainzClient *musicbrainz_client_;
 
@@ -23,6 +23,9 @@
 
 #include <QtGlobal>
 #include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+#include <QMutex>
 #include <QFile>
 #include <QFileInfo>
 #include <QTimer>
@@ -32,6 +35,10 @@
 #include <QStandardPaths>
 #include <QtDebug>
 
+#ifdef Q_OS_LINUX
+#  include <fcntl.h>
+#endif
+
 #include "core/logging.h"
 #include "core/utilities.h"
 #include "core/taskmanager.h"
@@ -46,8 +53,10 @@ class OrganiseFormat;
 
 using std::placeholders::_1;
 
-const int Organise::kBatchSize = 10;
+const int Organise::kReadAheadWorkers = 2;
+const int Organise::kReadAheadSize = 20;
 #ifdef HAVE_GSTREAMER
+const int Organise::kMaxTranscodingJobs = QThread::idealThreadCount() * 2;
 const int Organise::kTranscodeProgressInterval = 500;
 #endif
 
@@ -65,15 +74,21 @@ Organise::Organise(TaskManager *task_manager, std::shared_ptr<MusicStorage> dest
       albumcover_(albumcover),
       eject_after_(eject_after),
       task_count_(songs_info.count()),
+      tasks_reading_(0),
+      tasks_copying_(0),
       tasks_complete_(0),
       started_(false),
-      task_id_(0),
-      current_copy_progress_(0) {
+      finished_(false),
+      task_id_(0) {
 
   original_thread_ = thread();
 
+  read_pool_.setMaxThreadCount(kReadAheadWorkers);
+  copy_pool_.setMaxThreadCount(destination_->MaxConcurrentCopies());
+
+  int index = 0;
   for (const NewSongInfo &song_info : songs_info) {
-    tasks_pending_ << Task(song_info);
+    tasks_pending_ << Task(song_info, index++);
   }
 
 }
@@ -98,6 +113,11 @@ void Organise::Start() {
 
 void Organise::ProcessSomeFiles() {
 
+  // Files go through a pipeline of stages: reading ahead, transcoding, copying and finally updating the rest of the application.
+  // Each stage has its own workers, and a stage only takes new files while the next one isn't full, so a slow destination doesn't fill up memory or the temporary directory.
+
+  if (finished_) return;
+
   if (!started_) {
     if (!destination_->StartCopy(&supported_filetypes_)) {
       // Failed to start - mark everything as failed :(
@@ -107,135 +127,237 @@ void Organise::ProcessSomeFiles() {
     started_ = true;
   }
 
-  // None left?
-  if (tasks_pending_.isEmpty()) {
+  // Pick up the files the workers are done with.
+  QList<QPair<Task, MusicStorage::CopyJob>> tasks_copied;
+  {
+    QMutexLocker l(&mutex_);
+    tasks_reading_ -= tasks_read_.count();
+    tasks_ready_ << tasks_read_;
+    tasks_read_.clear();
+    tasks_copied = tasks_copied_;
+    tasks_copied_.clear();
+  }
+
+  for (const QPair<Task, MusicStorage::CopyJob> &task_and_job : tasks_copied) {
+    --tasks_copying_;
+    FinishCopy(task_and_job.first, task_and_job.second);
+  }
+
+  // Read ahead
+  while (!tasks_pending_.isEmpty() && tasks_reading_ < kReadAheadWorkers && tasks_reading_ + tasks_ready_.count() < kReadAheadSize) {
+    Task task = tasks_pending_.takeFirst();
+    ++tasks_reading_;
+    QtConcurrent::run(&read_pool_, this, &Organise::ReadFile, task);
+  }
+
+  // Transcode or copy the files that have been read
+  for (QList<Task>::iterator it = tasks_ready_.begin(); it != tasks_ready_.end();) {
+    Task &task = *it;
+    Song song = task.song_info_.song_;
+    if (!song.is_valid()) {
+      it = tasks_ready_.erase(it);
+      continue;
+    }
+    if (!task.embedded_cover_.isNull()) song.set_image(task.embedded_cover_);
+
 #ifdef HAVE_GSTREAMER
-    if (!tasks_transcoding_.isEmpty()) {
-      // Just wait - FileTranscoded will start us off again in a little while
-      qLog(Debug) << "Waiting for transcoding jobs";
-      transcode_progress_timer_.start(kTranscodeProgressInterval, this);
-      return;
+    if (task.transcoded_filename_.isEmpty() && CheckTranscode(song.filetype()) != Song::FileType_Unknown) {
+      if (tasks_transcoding_.count() >= kMaxTranscodingJobs) {
+        ++it;
+        continue;
+      }
+      if (MaybeTranscode(&task, song)) {
+        it = tasks_ready_.erase(it);
+        continue;
+      }
     }
 #endif
 
-    UpdateProgress();
+    if (tasks_copying_ >= copy_pool_.maxThreadCount()) {
+      ++it;
+      continue;
+    }
 
-    destination_->FinishCopy(files_with_errors_.isEmpty());
-    if (eject_after_) destination_->Eject();
+    const MusicStorage::CopyJob job = CreateCopyJob(task, song);
+    ++tasks_copying_;
+    QtConcurrent::run(&copy_pool_, this, &Organise::CopyFile, task, job);
+    it = tasks_ready_.erase(it);
+  }
 
-    task_manager_->SetTaskFinished(task_id_);
+  UpdateProgress();
 
-    emit Finished(files_with_errors_, log_);
+#ifdef HAVE_GSTREAMER
+  // FileTranscoded will start us off again when a transcode is done, until then keep the progress of the running ones updated.
+  if (!tasks_transcoding_.isEmpty()) {
+    transcode_progress_timer_.start(kTranscodeProgressInterval, this);
+    return;
+  }
+#endif
 
-    // Move back to the original thread so deleteLater() can get called in the main thread's event loop
-    moveToThread(original_thread_);
-    deleteLater();
+  // Anything left?
+  if (!tasks_pending_.isEmpty() || tasks_reading_ > 0 || !tasks_ready_.isEmpty() || tasks_copying_ > 0) return;
 
-    // Stop this thread
-    thread_->quit();
-    return;
+  Finish();
+
+}
+
+void Organise::Finish() {
+
+  finished_ = true;
+
+  UpdateProgress();
+
+  destination_->FinishCopy(files_with_errors_.isEmpty());
+  if (eject_after_) destination_->Eject();
+
+  task_manager_->SetTaskFinished(task_id_);
+
+  emit Finished(files_with_errors_, log_);
+
+  // Move back to the original thread so deleteLater() can get called in the main thread's event loop
+  moveToThread(original_thread_);
+  deleteLater();
+
+  // Stop this thread
+  thread_->quit();
+
+}
+
+void Organise::ReadFile(Task task) {
+
+  const QString filename = task.song_info_.song_.url().toLocalFile();
+  qLog(Info) << "Processing" << filename;
+
+  // Get embedded album cover, it's only used by storages that copy covers.
+  if (albumcover_) {
+    task.embedded_cover_ = TagReaderClient::Instance()->LoadEmbeddedArtBlocking(filename);
   }
 
-  // We process files in batches so we can be cancelled part-way through.
-  for (int i = 0; i < kBatchSize; ++i) {
-    SetSongProgress(0);
+#ifdef Q_OS_LINUX
+  // Ask the kernel to start reading the file into the page cache so it's there by the time it's copied.
+  QFile file(filename);
+  if (copy_ && file.open(QIODevice::ReadOnly)) {
+    posix_fadvise(file.handle(), 0, 0, POSIX_FADV_WILLNEED);
+    file.close();
+  }
+#endif
 
-    if (tasks_pending_.isEmpty()) break;
+  {
+    QMutexLocker l(&mutex_);
+    tasks_read_ << task;
+  }
 
-    Task task = tasks_pending_.takeFirst();
-    qLog(Info) << "Processing" << task.song_info_.song_.url().toLocalFile();
+  QMetaObject::invokeMethod(this, "ProcessSomeFiles", Qt::QueuedConnection);
 
-    // Use a Song instead of a tag reader
-    Song song = task.song_info_.song_;
-    if (!song.is_valid()) continue;
+}
+
+#ifdef HAVE_GSTREAMER
+bool Organise::MaybeTranscode(Task *task, const Song &song) {
+
+  // Figure out if we need to transcode it
+  Song::FileType dest_type = CheckTranscode(song.filetype());
+  if (dest_type == Song::FileType_Unknown) return false;
+
+  // Get the preset
+  TranscoderPreset preset = Transcoder::PresetForFileType(dest_type);
+  qLog(Debug) << "Transcoding with" << preset.name_;
+
+  task->transcoded_filename_ = transcoder_->GetFile(task->song_info_.song_.url().toLocalFile(), preset);
+  task->new_extension_ = preset.extension_;
+  task->new_filetype_ = dest_type;
+  tasks_transcoding_[task->song_info_.song_.url().toLocalFile()] = *task;
+  qLog(Debug) << "Transcoding to" << task->transcoded_filename_;
 
-    // Get embedded album cover
-    QImage cover = TagReaderClient::Instance()->LoadEmbeddedArtBlocking(task.song_info_.song_.url().toLocalFile());
-    if (!cover.isNull()) song.set_image(cover);
+  // Start the transcoding - this will happen in the background and FileTranscoded() will get called when it's done.
+  // At that point the task will get re-added to the ready queue with the new filename.
+  transcoder_->AddJob(task->song_info_.song_.url().toLocalFile(), preset, task->transcoded_filename_);
+  transcoder_->Start();
+
+  return true;
+
+}
+#endif
+
+MusicStorage::CopyJob Organise::CreateCopyJob(const Task &task, Song song) const {
 
 #ifdef HAVE_GSTREAMER
-    // Maybe this file is one that's been transcoded already?
-    if (!task.transcoded_filename_.isEmpty()) {
-      qLog(Debug) << "This file has already been transcoded";
+  // Maybe this file is one that's been transcoded already?
+  if (!task.transcoded_filename_.isEmpty()) {
+    qLog(Debug) << "This file has already been transcoded";
 
-      // Set the new filetype on the song so the formatter gets it right
-      song.set_filetype(task.new_filetype_);
+    // Set the new filetype on the song so the formatter gets it right
+    song.set_filetype(task.new_filetype_);
 
-      // Fiddle the filename extension as well to match the new type
-      song.set_url(QUrl::fromLocalFile(Utilities::FiddleFileExtension(song.basefilename(), task.new_extension_)));
-      song.set_basefilename(Utilities::FiddleFileExtension(song.basefilename(), task.new_extension_));
+    // Fiddle the filename extension as well to match the new type
+    song.set_url(QUrl::fromLocalFile(Utilities::FiddleFileExtension(song.basefilename(), task.new_extension_)));
+    song.set_basefilename(Utilities::FiddleFileExtension(song.basefilename(), task.new_extension_));
 
-      // Have to set this to the size of the new file or else funny stuff happens
-      song.set_filesize(QFileInfo(task.transcoded_filename_).size());
-    }
-    else {
-      // Figure out if we need to transcode it
-      Song::FileType dest_type = CheckTranscode(song.filetype());
-      if (dest_type != Song::FileType_Unknown) {
-        // Get the preset
-        TranscoderPreset preset = Transcoder::PresetForFileType(dest_type);
-        qLog(Debug) << "Transcoding with" << preset.name_;
-
-        task.transcoded_filename_ = transcoder_->GetFile(task.song_info_.song_.url().toLocalFile(), preset);
-        task.new_extension_ = preset.extension_;
-        task.new_filetype_ = dest_type;
-        tasks_transcoding_[task.song_info_.song_.url().toLocalFile()] = task;
-        qLog(Debug) << "Transcoding to" << task.transcoded_filename_;
-
-        // Start the transcoding - this will happen in the background and FileTranscoded() will get called when it's done.
-	// At that point the task will get re-added to the pending queue with the new filename.
-        transcoder_->AddJob(task.song_info_.song_.url().toLocalFile(), preset, task.transcoded_filename_);
-        transcoder_->Start();
-        continue;
-      }
-    }
+    // Have to set this to the size of the new file or else funny stuff happens
+    song.set_filesize(QFileInfo(task.transcoded_filename_).size());
+  }
 #endif
 
-    MusicStorage::CopyJob job;
-    job.source_ = task.transcoded_filename_.isEmpty() ? task.song_info_.song_.url().toLocalFile() : task.transcoded_filename_;
-    job.destination_ = task.song_info_.new_filename_;
-    job.metadata_ = song;
-    job.overwrite_ = overwrite_;
-    job.mark_as_listened_ = mark_as_listened_;
-    job.albumcover_ = albumcover_;
-    job.remove_original_ = !copy_;
-
-    if (!task.song_info_.song_.art_manual().isEmpty()) {
-      job.cover_source_ = task.song_info_.song_.art_manual();
-    }
-    else if (!task.song_info_.song_.art_automatic().isEmpty()) {
-      job.cover_source_ = task.song_info_.song_.art_automatic();
-    }
-    if (!job.cover_source_.isEmpty()) {
-      job.cover_dest_ = QFileInfo(job.destination_).path() + "/" + QFileInfo(job.cover_source_).fileName();
-    }
+  MusicStorage::CopyJob job;
+  job.source_ = task.transcoded_filename_.isEmpty() ? task.song_info_.song_.url().toLocalFile() : task.transcoded_filename_;
+  job.destination_ = task.song_info_.new_filename_;
+  job.metadata_ = song;
+  job.overwrite_ = overwrite_;
+  job.mark_as_listened_ = mark_as_listened_;
+  job.albumcover_ = albumcover_;
+  job.remove_original_ = !copy_;
+
+  if (!task.song_info_.song_.art_manual().isEmpty()) {
+    job.cover_source_ = task.song_info_.song_.art_manual();
+  }
+  else if (!task.song_info_.song_.art_automatic().isEmpty()) {
+    job.cover_source_ = task.song_info_.song_.art_automatic();
+  }
+  if (!job.cover_source_.isEmpty()) {
+    job.cover_dest_ = QFileInfo(job.destination_).path() + "/" + QFileInfo(job.cover_source_).fileName();
+  }
 
-    job.progress_ = std::bind(&Organise::SetSongProgress, this, _1, !task.transcoded_filename_.isEmpty());
+  return job;
 
-    if (!destination_->CopyToStorage(job)) {
-      files_with_errors_ << task.song_info_.song_.basefilename();
-    }
-    else {
-      if (job.remove_original_) {
-        // Notify other aspects of system that song has been invalidated
-        QString root = destination_->LocalPath();
-        QFileInfo new_file = QFileInfo(root + "/" + task.song_info_.new_filename_);
-        emit SongPathChanged(song, new_file);
-      }
-      if (job.mark_as_listened_) {
-        emit FileCopied(job.metadata_.id());
-      }
-    }
+}
 
-    // Clean up the temporary transcoded file
-    if (!task.transcoded_filename_.isEmpty())
-      QFile::remove(task.transcoded_filename_);
+void Organise::CopyFile(Task task, MusicStorage::CopyJob job) {
 
-    tasks_complete_++;
+  job.progress_ = std::bind(&Organise::SetSongProgress, this, task.index_, _1, !task.transcoded_filename_.isEmpty());
+
+  task.copy_success_ = destination_->CopyToStorage(job);
+
+  {
+    QMutexLocker l(&mutex_);
+    copy_progress_.remove(task.index_);
+    tasks_copied_ << qMakePair(task, job);
   }
-  SetSongProgress(0);
 
-  QTimer::singleShot(0, this, SLOT(ProcessSomeFiles()));
+  QMetaObject::invokeMethod(this, "ProcessSomeFiles", Qt::QueuedConnection);
+
+}
+
+void Organise::FinishCopy(const Task &task, const MusicStorage::CopyJob &job) {
+
+  if (!task.copy_success_) {
+    files_with_errors_ << task.song_info_.song_.basefilename();
+  }
+  else {
+    if (job.remove_original_) {
+      // Notify other aspects of system that song has been invalidated
+      QString root = destination_->LocalPath();
+      QFileInfo new_file = QFileInfo(root + "/" + task.song_info_.new_filename_);
+      emit SongPathChanged(job.metadata_, new_file);
+    }
+    if (job.mark_as_listened_) {
+      emit FileCopied(job.metadata_.id());
+    }
+  }
+
+  // Clean up the temporary transcoded file
+  if (!task.transcoded_filename_.isEmpty())
+    QFile::remove(task.transcoded_filename_);
+
+  tasks_complete_++;
 
 }
 
@@ -268,11 +390,14 @@ Song::FileType Organise::CheckTranscode(Song::FileType original_type) const {
 }
 #endif
 
-void Organise::SetSongProgress(float progress, bool transcoded) {
+void Organise::SetSongProgress(int index, float progress, bool transcoded) {
 
   const int max = transcoded ? 50 : 100;
-  current_copy_progress_ = (transcoded ? 50 : 0) + qBound(0, static_cast<int>(progress * max), max - 1);
-  UpdateProgress();
+  {
+    QMutexLocker l(&mutex_);
+    copy_progress_[index] = (transcoded ? 50 : 0) + qBound(0, static_cast<int>(progress * max), max - 1);
+  }
+  QMetaObject::invokeMethod(this, "UpdateProgress", Qt::QueuedConnection);
 
 }
 
@@ -293,7 +418,7 @@ void Organise::UpdateProgress() {
   // Files that need transcoding total 50 for the transcode and 50 for the copy, files that only need to be copied total 100.
   int progress = tasks_complete_ * 100;
 
-  for (const Task &task : tasks_pending_) {
+  for (const Task &task : tasks_ready_) {
     progress += qBound(0, static_cast<int>(task.transcode_progress_ * 50), 50);
   }
 #ifdef HAVE_GSTREAMER
@@ -302,11 +427,25 @@ void Organise::UpdateProgress() {
   }
 #endif
 
-  // Add the progress of the track that's currently copying
-  progress += current_copy_progress_;
+  // Add the progress of the tracks that are currently copying
+  {
+    QMutexLocker l(&mutex_);
+    for (int copy_progress : copy_progress_.values()) progress += copy_progress;
+  }
 
   task_manager_->SetTaskProgress(task_id_, progress, total);
 
+  // Show how many files are in each stage of the pipeline
+  int transcoding = 0;
+#ifdef HAVE_GSTREAMER
+  transcoding = tasks_transcoding_.count();
+#endif
+  const QString task_name = tr("Organising files (%1 reading, %2 transcoding, %3 copying, %4 of %5 done)").arg(tasks_reading_).arg(transcoding).arg(tasks_copying_).arg(tasks_complete_).arg(task_count_);
+  if (task_name != task_name_) {
+    task_name_ = task_name;
+    task_manager_->SetTaskName(task_id_, task_name_);
+  }
+
 }
 
 #ifdef HAVE_GSTREAMER
@@ -320,7 +459,7 @@ void Organise::FileTranscoded(const QString &input, const QString &output, bool
     files_with_errors_ << input;
   }
   else {
-    tasks_pending_ << task;
+    tasks_ready_ << task;
   }
   QTimer::singleShot(0, this, SLOT(ProcessSomeFiles()));
 
@@ -29,22 +29,26 @@
 
 #include <QObject>
 #include <QThread>
+#include <QThreadPool>
+#include <QMutex>
 #include <QBasicTimer>
 #include <QFileInfo>
 #include <QList>
 #include <QVector>
 #include <QMap>
+#include <QPair>
 #include <QSet>
 #include <QString>
 #include <QStringList>
+#include <QImage>
 #include <QTemporaryFile>
 
 #include "core/song.h"
+#include "core/musicstorage.h"
 #include "organiseformat.h"
 
 class QTimerEvent;
 
-class MusicStorage;
 class TaskManager;
 #ifdef HAVE_GSTREAMER
 class Transcoder;
@@ -63,8 +67,10 @@ class Organise : public QObject {
 
   Organise(TaskManager *task_manager, std::shared_ptr<MusicStorage> destination, const OrganiseFormat &format, bool copy, bool overwrite, bool mark_as_listened, bool albumcover, const NewSongInfoList &songs, bool eject_after);
 
-  static const int kBatchSize;
+  static const int kReadAheadWorkers;
+  static const int kReadAheadSize;
 #ifdef HAVE_GSTREAMER
+  static const int kMaxTranscodingJobs;
   static const int kTranscodeProgressInterval;
 #endif
 
@@ -84,28 +90,43 @@ class Organise : public QObject {
   void FileTranscoded(const QString &input, const QString &output, bool success);
 #endif
   void LogLine(const QString message);
+  void UpdateProgress();
 
  private:
-  void SetSongProgress(float progress, bool transcoded = false);
-  void UpdateProgress();
+  void SetSongProgress(int index, float progress, bool transcoded = false);
+  void Finish();
 #ifdef HAVE_GSTREAMER
   Song::FileType CheckTranscode(Song::FileType original_type) const;
 #endif
 
  private:
   struct Task {
-    explicit Task(const NewSongInfo &song_info = NewSongInfo()) :
+    explicit Task(const NewSongInfo &song_info = NewSongInfo(), const int index = -1) :
       song_info_(song_info),
-      transcode_progress_(0.0)
+      index_(index),
+      transcode_progress_(0.0),
+      copy_success_(false)
       {}
 
     NewSongInfo song_info_;
+    int index_;
     float transcode_progress_;
     QString transcoded_filename_;
     QString new_extension_;
     Song::FileType new_filetype_;
+    QImage embedded_cover_;
+    bool copy_success_;
   };
 
+  // Pipeline stages, each running in its own thread pool and handing the task back to ProcessSomeFiles() when done.
+  void ReadFile(Task task);
+  void CopyFile(Task task, MusicStorage::CopyJob job);
+
+  // Starts the transcode if the task needs one, returns false if it should be copied as is.
+  bool MaybeTranscode(Task *task, const Song &song);
+  MusicStorage::CopyJob CreateCopyJob(const Task &task, Song song) const;
+  void FinishCopy(const Task &task, const MusicStorage::CopyJob &job);
+
   QThread *thread_;
   QThread *original_thread_;
   TaskManager *task_manager_;
@@ -127,16 +148,29 @@ class Organise : public QObject {
   QBasicTimer transcode_progress_timer_;
 #endif
 
+  QThreadPool read_pool_;
+  QThreadPool copy_pool_;
+
+  // Protects the lists the worker threads hand their tasks back in, and the copy progress.
+  QMutex mutex_;
+
   QList<Task> tasks_pending_;
+  int tasks_reading_;
+  QList<Task> tasks_read_;
+  QList<Task> tasks_ready_;
 #ifdef HAVE_GSTREAMER
   QMap<QString, Task> tasks_transcoding_;
 #endif
+  QList<QPair<Task, MusicStorage::CopyJob>> tasks_copied_;
+  int tasks_copying_;
   int tasks_complete_;
 
   bool started_;
+  bool finished_;
 
   int task_id_;
-  int current_copy_progress_;
+  QString task_name_;
+  QMap<int, int> copy_progress_;
 
   QStringList files_with_errors_;
   QStringList log_;
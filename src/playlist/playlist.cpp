@@ -116,6 +116,8 @@ const char *Playlist::kWriteMetadata = "write_metadata";
 const int Playlist::kUndoStackSize = 20;
 const int Playlist::kUndoItemLimit = 500;
 
+const int Playlist::kRestorePageSize = 2000;
+
 const qint64 Playlist::kMinScrobblePointNsecs = 31ll * kNsecPerSec;
 const qint64 Playlist::kMaxScrobblePointNsecs = 240ll * kNsecPerSec;
 
@@ -137,6 +139,10 @@ Playlist::Playlist(PlaylistBackend *backend, TaskManager *task_manager, Collecti
       undo_stack_(new QUndoStack(this)),
       special_type_(special_type),
       cancel_restore_(false),
+      restore_started_(false),
+      restoring_(false),
+      restore_row_(0),
+      save_after_restore_(false),
       scrobbled_(false),
       nowplaying_(false),
       scrobble_point_(-1) {
@@ -146,8 +152,6 @@ Playlist::Playlist(PlaylistBackend *backend, TaskManager *task_manager, Collecti
   connect(this, SIGNAL(rowsInserted(const QModelIndex&, int, int)), SIGNAL(PlaylistChanged()));
   connect(this, SIGNAL(rowsRemoved(const QModelIndex&, int, int)), SIGNAL(PlaylistChanged()));
 
-  Restore();
-
   proxy_->setSourceModel(this);
   queue_->setSourceModel(this);
 
@@ -914,9 +918,18 @@ void Playlist::InsertItemsWithoutUndo(const PlaylistItemList &items, int pos, bo
 
   if (items.isEmpty()) return;
 
+  if (!is_loading_) {
+    // Playlists are restored lazily, make sure anything added now ends up after the saved items
+    EnsureRestored();
+  }
+
   const int start = pos == -1 ? items_.count() : pos;
   const int end = start + items.count() - 1;
 
+  if (restoring_ && !is_loading_ && start < restore_row_) {
+    restore_row_ += items.count();
+  }
+
   beginInsertRows(QModelIndex(), start, end);
   for (int i = start; i <= end; ++i) {
     PlaylistItemPtr item = items[i - start];
@@ -1275,12 +1288,25 @@ void Playlist::SetCurrentIsPaused(bool paused) {
 }
 
 void Playlist::Save() const {
+
   if (!backend_ || is_loading_) return;
 
+  // Saving a partially restored playlist would drop the items that haven't been loaded yet
+  if (restoring_) {
+    save_after_restore_ = true;
+    return;
+  }
+
   backend_->SavePlaylistAsync(id_, items_, last_played_row());
 
 }
 
+void Playlist::EnsureRestored() {
+
+  if (!restore_started_) Restore();
+
+}
+
 void Playlist::Restore() {
 
   if (!backend_) return;
@@ -1290,16 +1316,35 @@ void Playlist::Restore() {
   collection_items_by_id_.clear();
 
   cancel_restore_ = false;
-  QFuture<QList<PlaylistItemPtr>> future = QtConcurrent::run(backend_, &PlaylistBackend::GetPlaylistItems, id_);
-  NewClosure(future, this, SLOT(ItemsLoaded(QFuture<PlaylistItemList>)), future);
+  restore_started_ = true;
+  restoring_ = true;
+  restore_row_ = 0;
+  save_after_restore_ = false;
+
+  LoadRestorePage(-1);
+
+}
+
+void Playlist::LoadRestorePage(const qint64 after_row_id) {
+
+  QFuture<PlaylistBackend::PlaylistItemsPage> future = QtConcurrent::run(backend_, &PlaylistBackend::GetPlaylistItemsPage, id_, after_row_id, kRestorePageSize);
+  NewClosure(future, this, SLOT(ItemsLoaded(QFuture<PlaylistBackend::PlaylistItemsPage>)), future);
 
 }
 
-void Playlist::ItemsLoaded(QFuture<PlaylistItemList> future) {
+void Playlist::ItemsLoaded(QFuture<PlaylistBackend::PlaylistItemsPage> future) {
 
-  if (cancel_restore_) return;
+  if (cancel_restore_) {
+    restoring_ = false;
+    if (save_after_restore_) {
+      save_after_restore_ = false;
+      Save();
+    }
+    return;
+  }
 
-  PlaylistItemList items = future.result();
+  PlaylistBackend::PlaylistItemsPage page = future.result();
+  PlaylistItemList &items = page.items;
 
   // Backend returns empty elements for collection items which it couldn't match (because they got deleted); we don't need those
   QMutableListIterator<PlaylistItemPtr> it(items);
@@ -1311,10 +1356,26 @@ void Playlist::ItemsLoaded(QFuture<PlaylistItemList> future) {
     }
   }
 
+  // Restoring isn't something the user should be able to undo, so go around the undo stack.
+  // Items the user added while we were loading stay where they are.
   is_loading_ = true;
-  InsertItems(items, 0);
+  InsertItemsWithoutUndo(items, qMin(restore_row_, items_.count()));
+  restore_row_ = qMin(restore_row_, items_.count()) + items.count();
   is_loading_ = false;
 
+  if (page.done) {
+    FinishRestore();
+  }
+  else {
+    LoadRestorePage(page.last_row_id);
+  }
+
+}
+
+void Playlist::FinishRestore() {
+
+  restoring_ = false;
+
   PlaylistBackend::Playlist p = backend_->GetPlaylist(id_);
 
   // The newly loaded list of items might be shorter than it was before so look out for a bad last_played index
@@ -1322,6 +1383,11 @@ void Playlist::ItemsLoaded(QFuture<PlaylistItemList> future) {
 
   emit RestoreFinished();
 
+  if (save_after_restore_) {
+    save_after_restore_ = false;
+    Save();
+  }
+
   QSettings s;
   s.beginGroup(kSettingsGroup);
   bool greyout = s.value("greyout_songs_startup", true).toBool();
@@ -1413,6 +1479,11 @@ PlaylistItemList Playlist::RemoveItemsWithoutUndo(int row, int count) {
   if (row < 0 || row >= items_.size() || row + count > items_.size()) {
     return PlaylistItemList();
   }
+
+  if (restoring_ && !is_loading_ && row < restore_row_) {
+    restore_row_ -= qMin(count, restore_row_ - row);
+  }
+
   beginRemoveRows(QModelIndex(), row, row + count - 1);
 
   // Remove items
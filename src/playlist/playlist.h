@@ -46,10 +46,10 @@
 #include "core/song.h"
 #include "core/tagreaderclient.h"
 #include "playlistitem.h"
+#include "playlistbackend.h"
 #include "playlistsequence.h"
 
 class CollectionBackend;
-class PlaylistBackend;
 class PlaylistFilter;
 class Queue;
 class TaskManager;
@@ -159,6 +159,8 @@ class Playlist : public QAbstractListModel {
   static const int kUndoStackSize;
   static const int kUndoItemLimit;
 
+  static const int kRestorePageSize;
+
   static const qint64 kMinScrobblePointNsecs;
   static const qint64 kMaxScrobblePointNsecs;
 
@@ -173,6 +175,9 @@ class Playlist : public QAbstractListModel {
   // Persistence
   void Save() const;
   void Restore();
+  // Starts restoring the playlist from the database unless that has already been done.
+  void EnsureRestored();
+  bool is_restored() const { return restore_started_ && !restoring_; }
 
   // Accessors
   QSortFilterProxyModel *proxy() const;
@@ -326,6 +331,9 @@ private:
 
   void RemoveItemsNotInQueue();
 
+  void LoadRestorePage(const qint64 after_row_id);
+  void FinishRestore();
+
   // Removes rows with given indices from this playlist.
   bool removeRows(QList<int> &rows);
 
@@ -336,7 +344,7 @@ private:
   void QueueLayoutChanged();
   void SongSaveComplete(TagReaderReply *reply, const QPersistentModelIndex &index);
   void ItemReloadComplete(const QPersistentModelIndex &index);
-  void ItemsLoaded(QFuture<PlaylistItemList> future);
+  void ItemsLoaded(QFuture<PlaylistBackend::PlaylistItemsPage> future);
   void SongInsertVetoListenerDestroyed();
 
 private:
@@ -383,6 +391,12 @@ private:
   // Cancel async restore if songs are already replaced
   bool cancel_restore_;
 
+  // The playlist is restored in pages; restore_row_ is where the next page goes.
+  bool restore_started_;
+  bool restoring_;
+  int restore_row_;
+  mutable bool save_after_restore_;
+
   bool scrobbled_;
   bool nowplaying_;
   qint64 scrobble_point_;
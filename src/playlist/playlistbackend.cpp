@@ -135,7 +135,7 @@ PlaylistBackend::Playlist PlaylistBackend::GetPlaylist(int id) {
 
 }
 
-QSqlQuery PlaylistBackend::GetPlaylistRows(int playlist) {
+QSqlQuery PlaylistBackend::GetPlaylistRows(int playlist, qint64 after_row_id, int limit) {
 
   QMutexLocker l(db_->Mutex());
   QSqlDatabase db(db_->Connect());
@@ -150,11 +150,19 @@ QSqlQuery PlaylistBackend::GetPlaylistRows(int playlist) {
                   " LEFT JOIN songs"
                   "    ON p.collection_id = songs.ROWID"
                   " WHERE p.playlist = :playlist";
+  // Pages are keyed on the item ROWID rather than an OFFSET so each page is a range scan starting where the last one stopped.
+  if (limit > 0) {
+    query += " AND p.ROWID > :after_row_id ORDER BY p.ROWID LIMIT :limit";
+  }
   QSqlQuery q(db);
   // Forward iterations only may be faster
   q.setForwardOnly(true);
   q.prepare(query);
   q.bindValue(":playlist", playlist);
+  if (limit > 0) {
+    q.bindValue(":after_row_id", after_row_id);
+    q.bindValue(":limit", limit);
+  }
   q.exec();
 
   return q;
@@ -177,6 +185,31 @@ QList<PlaylistItemPtr> PlaylistBackend::GetPlaylistItems(int playlist) {
 
 }
 
+PlaylistBackend::PlaylistItemsPage PlaylistBackend::GetPlaylistItemsPage(int playlist, qint64 after_row_id, int limit) {
+
+  PlaylistItemsPage page;
+  page.last_row_id = after_row_id;
+
+  QSqlQuery q = GetPlaylistRows(playlist, after_row_id, limit);
+  if (db_->CheckErrors(q)) return page;
+
+  // The playlist item ROWID follows the songs table columns
+  const int row_id_column = Song::kColumns.count() + 1;
+
+  std::shared_ptr<NewSongFromQueryState> state_ptr(new NewSongFromQueryState());
+  int count = 0;
+  while (q.next()) {
+    SqlRow row(q);
+    page.last_row_id = row.value(row_id_column).toLongLong();
+    page.items << NewPlaylistItemFromQuery(row, state_ptr);
+    ++count;
+  }
+  page.done = count < limit;
+
+  return page;
+
+}
+
 QList<Song> PlaylistBackend::GetPlaylistSongs(int playlist) {
 
   QSqlQuery q = GetPlaylistRows(playlist);
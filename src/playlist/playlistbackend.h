@@ -60,6 +60,15 @@ class PlaylistBackend : public QObject {
   };
   typedef QList<Playlist> PlaylistList;
 
+  // One page of a playlist, as returned by GetPlaylistItemsPage().  Pass last_row_id back in to get the next page.
+  struct PlaylistItemsPage {
+    PlaylistItemsPage() : last_row_id(-1), done(true) {}
+
+    PlaylistItemList items;
+    qint64 last_row_id;
+    bool done;
+  };
+
   static const int kSongTableJoins;
 
   PlaylistList GetAllPlaylists();
@@ -68,6 +77,7 @@ class PlaylistBackend : public QObject {
   PlaylistBackend::Playlist GetPlaylist(int id);
 
   QList<PlaylistItemPtr> GetPlaylistItems(int playlist);
+  PlaylistItemsPage GetPlaylistItemsPage(int playlist, qint64 after_row_id, int limit);
   QList<Song> GetPlaylistSongs(int playlist);
 
   void SetPlaylistOrder(const QList<int> &ids);
@@ -90,7 +100,7 @@ class PlaylistBackend : public QObject {
     QMutex mutex_;
   };
 
-  QSqlQuery GetPlaylistRows(int playlist);
+  QSqlQuery GetPlaylistRows(int playlist, qint64 after_row_id = -1, int limit = -1);
 
   Song NewSongFromQuery(const SqlRow &row, std::shared_ptr<NewSongFromQueryState> state);
   PlaylistItemPtr NewPlaylistItemFromQuery(const SqlRow &row, std::shared_ptr<NewSongFromQueryState> state);
@@ -68,7 +68,8 @@ PlaylistManager::PlaylistManager(Application *app, QObject *parent)
       parser_(nullptr),
       playlist_container_(nullptr),
       current_(-1),
-      active_(-1)
+      active_(-1),
+      initialized_(false)
 {
   connect(app_->player(), SIGNAL(Paused()), SLOT(SetActivePaused()));
   connect(app_->player(), SIGNAL(Playing()), SLOT(SetActivePlaying()));
@@ -98,6 +99,11 @@ void PlaylistManager::Init(CollectionBackend *collection_backend, PlaylistBacken
   // If no playlist exists then make a new one
   if (playlists_.isEmpty()) New(tr("Playlist"));
 
+  // Restore the visible playlist first, the rest are loaded when they're first shown
+  initialized_ = true;
+  current()->EnsureRestored();
+  active()->EnsureRestored();
+
   emit PlaylistManagerInitialized();
 
 }
@@ -188,7 +194,7 @@ void PlaylistManager::Load(const QString &filename) {
 
 void PlaylistManager::Save(int id, const QString &filename, Playlist::Path path_type) {
 
-  if (playlists_.contains(id)) {
+  if (playlists_.contains(id) && playlist(id)->is_restored()) {
     parser_->Save(playlist(id)->GetAllSongs(), filename, path_type);
   }
   else {
@@ -349,6 +355,7 @@ void PlaylistManager::SetCurrentPlaylist(int id) {
 
   Q_ASSERT(playlists_.contains(id));
   current_ = id;
+  if (initialized_) current()->EnsureRestored();
   emit CurrentChanged(current());
   UpdateSummaryText();
 
@@ -363,6 +370,7 @@ void PlaylistManager::SetActivePlaylist(int id) {
   if (active_ != -1 && active_ != id) active()->set_current_row(-1);
 
   active_ = id;
+  if (initialized_) active()->EnsureRestored();
   emit ActiveChanged(active());
 
 }
@@ -237,6 +237,9 @@ class PlaylistManager : public PlaylistManagerInterface {
 
   int current_;
   int active_;
+
+  // Playlists are only restored once they are shown or played, after Init() has restored the current and active one.
+  bool initialized_;
 };
 
 #endif  // PLAYLISTMANAGER_H
@@ -26,6 +26,7 @@
 #include <QTextStream>
 
 #include "asxiniparser.h"
+#include "linereader.h"
 #include "playlistparsers/parserbase.h"
 
 class CollectionBackendInterface;
@@ -39,19 +40,24 @@ bool AsxIniParser::TryMagic(const QByteArray &data) const {
 
 SongList AsxIniParser::Load(QIODevice *device, const QString &playlist_path, const QDir &dir) const {
 
-  SongList ret;
+  QList<SongEntry> entries;
 
-  while (!device->atEnd()) {
-    QString line = QString::fromUtf8(device->readLine()).trimmed();
+  LineReader reader(device);
+  while (!reader.atEnd()) {
+    QString line = QString::fromUtf8(reader.ReadLine()).trimmed();
     int equals = line.indexOf('=');
     QString key = line.left(equals).toLower();
     QString value = line.mid(equals + 1);
 
     if (key.startsWith("ref")) {
-      Song song = LoadSong(value, 0, dir);
-      if (song.is_valid()) {
-        ret << song;
-      }
+      entries << SongEntry(value);
+    }
+  }
+
+  SongList ret;
+  for (const Song &song : LoadSongs(entries, dir)) {
+    if (song.is_valid()) {
+      ret << song;
     }
   }
 
@@ -78,8 +78,24 @@ SongList ASXParser::Load(QIODevice *device, const QString &playlist_path, const
     return ret;
   }
 
+  QList<SongEntry> entries;
+  SongList playlist_songs;
   while (!reader.atEnd() && Utilities::ParseUntilElement(&reader, "entry")) {
-    Song song = ParseTrack(&reader, dir);
+    QString ref;
+    playlist_songs << ParseTrack(&reader, &ref);
+    entries << SongEntry(ref);
+  }
+
+  SongList songs = LoadSongs(entries, dir);
+  for (int i = 0; i < songs.count(); ++i) {
+    Song &song = songs[i];
+    const Song &playlist_song = playlist_songs[i];
+
+    // Override metadata with what was in the playlist
+    song.set_title(playlist_song.title());
+    song.set_artist(playlist_song.artist());
+    song.set_album(playlist_song.album());
+
     if (song.is_valid()) {
       ret << song;
     }
@@ -88,9 +104,9 @@ SongList ASXParser::Load(QIODevice *device, const QString &playlist_path, const
 
 }
 
-Song ASXParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir) const {
+Song ASXParser::ParseTrack(QXmlStreamReader *reader, QString *ref) const {
 
-  QString title, artist, album, ref;
+  QString title, artist, album;
 
   while (!reader->atEnd()) {
     QXmlStreamReader::TokenType type = reader->readNext();
@@ -99,7 +115,7 @@ Song ASXParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir) const {
       case QXmlStreamReader::StartElement: {
         QStringRef name = reader->name();
         if (name == "ref") {
-          ref = reader->attributes().value("href").toString();
+          *ref = reader->attributes().value("href").toString();
         } else if (name == "title") {
           title = reader->readElementText();
         } else if (name == "author") {
@@ -119,9 +135,8 @@ Song ASXParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir) const {
   }
 
 return_song:
-  Song song = LoadSong(ref, 0, dir);
-
-  // Override metadata with what was in the playlist
+  // Only the metadata from the playlist, the song itself is loaded later
+  Song song;
   song.set_title(title);
   song.set_artist(artist);
   song.set_album(album);
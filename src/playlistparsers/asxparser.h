@@ -53,7 +53,7 @@ class ASXParser : public XMLParser {
   void Save(const SongList &songs, QIODevice *device, const QDir &dir = QDir(), Playlist::Path path_type = Playlist::Path_Automatic) const;
 
  private:
-  Song ParseTrack(QXmlStreamReader *reader, const QDir &dir) const;
+  Song ParseTrack(QXmlStreamReader *reader, QString *ref) const;
 };
 
 #endif
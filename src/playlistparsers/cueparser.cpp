@@ -234,11 +234,17 @@ SongList CueParser::Load(QIODevice *device, const QString &playlist_path, const
 
   QDateTime cue_mtime = QFileInfo(playlist_path).lastModified();
 
+  QList<SongEntry> song_entries;
+  for (const CueEntry &entry : entries) {
+    song_entries << SongEntry(entry.file, IndexToMarker(entry.index));
+  }
+  SongList songs = LoadSongs(song_entries, dir);
+
   // Finalize parsing songs
   for (int i = 0; i < entries.length(); i++) {
     CueEntry entry = entries.at(i);
 
-    Song song = LoadSong(entry.file, IndexToMarker(entry.index), dir);
+    Song song = songs[i];
 
     // Cue song has mtime equal to qMax(media_file_mtime, cue_sheet_mtime)
     if (cue_mtime.isValid()) {
@@ -0,0 +1,102 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QIODevice>
+#include <QFileDevice>
+#include <QByteArray>
+
+#include "linereader.h"
+
+const qint64 LineReader::kChunkSize = 65536;
+
+LineReader::LineReader(QIODevice *device)
+    : device_(device),
+      file_(qobject_cast<QFileDevice*>(device)),
+      map_(nullptr),
+      data_(nullptr),
+      size_(0),
+      pos_(0) {
+
+  // Map the rest of the file if we can, the kernel pages it in as we go and drops it again under memory pressure
+  if (file_ && file_->size() > file_->pos()) {
+    map_ = file_->map(file_->pos(), file_->size() - file_->pos());
+    if (map_) {
+      data_ = reinterpret_cast<const char*>(map_);
+      size_ = file_->size() - file_->pos();
+    }
+  }
+
+}
+
+LineReader::~LineReader() {
+
+  if (map_) file_->unmap(map_);
+
+}
+
+bool LineReader::Refill() {
+
+  if (map_ || device_->atEnd()) return false;
+
+  const QByteArray chunk = device_->read(kChunkSize);
+  if (chunk.isEmpty()) return false;
+
+  // Keep the partial line we have, and append the next chunk
+  buffer_ = buffer_.mid(static_cast<int>(pos_)) + chunk;
+  data_ = buffer_.constData();
+  size_ = buffer_.size();
+  pos_ = 0;
+
+  return true;
+
+}
+
+bool LineReader::atEnd() {
+
+  return pos_ >= size_ && !Refill();
+
+}
+
+QByteArray LineReader::ReadLine() {
+
+  forever {
+    const char *begin = data_ + pos_;
+    const char *end = data_ + size_;
+    const char *p = begin;
+    while (p < end && *p != '\n' && *p != '\r') ++p;
+
+    // Make sure a \r\n split between two chunks isn't read as two line endings
+    if ((p == end || (*p == '\r' && p + 1 == end)) && Refill()) continue;
+
+    QByteArray line(begin, p - begin);
+    pos_ = p - data_;
+
+    // Skip the line ending, \r\n counts as one
+    if (pos_ < size_) {
+      if (data_[pos_] == '\r' && pos_ + 1 < size_ && data_[pos_ + 1] == '\n') ++pos_;
+      ++pos_;
+    }
+
+    return line;
+  }
+
+}
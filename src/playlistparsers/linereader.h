@@ -0,0 +1,63 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LINEREADER_H
+#define LINEREADER_H
+
+#include "config.h"
+
+#include <stdbool.h>
+
+#include <QtGlobal>
+#include <QByteArray>
+
+class QIODevice;
+class QFileDevice;
+
+// Reads a playlist line by line without first copying the whole file into memory.
+// Files are memory mapped, other devices are read in chunks.
+// This only saves the copies of the file itself, the parsers still build the complete song list.
+// \r, \n and \r\n are all accepted as line endings.
+class LineReader {
+ public:
+  explicit LineReader(QIODevice *device);
+  ~LineReader();
+
+  bool atEnd();
+
+  // Returns the next line without the line ending.
+  QByteArray ReadLine();
+
+ private:
+  Q_DISABLE_COPY(LineReader)
+
+  static const qint64 kChunkSize;
+
+  bool Refill();
+
+  QIODevice *device_;
+  QFileDevice *file_;
+  uchar *map_;
+  QByteArray buffer_;
+  const char *data_;
+  qint64 size_;
+  qint64 pos_;
+};
+
+#endif  // LINEREADER_H
@@ -21,7 +21,6 @@
 #include <QObject>
 #include <QIODevice>
 #include <QDir>
-#include <QBuffer>
 #include <QByteArray>
 #include <QList>
 #include <QVariant>
@@ -34,6 +33,7 @@
 #include "core/logging.h"
 #include "core/timeconstants.h"
 #include "m3uparser.h"
+#include "linereader.h"
 #include "playlist/playlist.h"
 #include "playlistparsers/parserbase.h"
 
@@ -44,23 +44,20 @@ M3UParser::M3UParser(CollectionBackendInterface *collection, QObject *parent)
 
 SongList M3UParser::Load(QIODevice *device, const QString &playlist_path, const QDir &dir) const {
 
-  SongList ret;
-
   M3UType type = STANDARD;
   Metadata current_metadata;
+  QList<SongEntry> entries;
+  QList<Metadata> entries_metadata;
 
-  QString data = QString::fromUtf8(device->readAll());
-  data.replace('\r', '\n');
-  data.replace("\n\n", "\n");
-  QByteArray bytes = data.toUtf8();
-  QBuffer buffer(&bytes);
-  buffer.open(QIODevice::ReadOnly);
+  // Read one line at a time, so the file isn't copied into a string and a buffer first.
+  // The entries and the songs made from them are still all kept until the list is returned.
+  LineReader reader(device);
 
-  QString line = QString::fromUtf8(buffer.readLine()).trimmed();
+  QString line = QString::fromUtf8(reader.ReadLine()).trimmed();
   if (line.startsWith("#EXTM3U")) {
     // This is in extended M3U format.
     type = EXTENDED;
-    line = QString::fromUtf8(buffer.readLine()).trimmed();
+    line = QString::fromUtf8(reader.ReadLine()).trimmed();
   }
 
   forever {
@@ -73,24 +70,30 @@ SongList M3UParser::Load(QIODevice *device, const QString &playlist_path, const
       }
     }
     else if (!line.isEmpty()) {
-      Song song = LoadSong(line, 0, dir);
-      if (!current_metadata.title.isEmpty()) {
-        song.set_title(current_metadata.title);
-      }
-      if (!current_metadata.artist.isEmpty()) {
-        song.set_artist(current_metadata.artist);
-      }
-      if (current_metadata.length > 0) {
-        song.set_length_nanosec(current_metadata.length);
-      }
-      ret << song;
+      entries << SongEntry(line);
+      entries_metadata << current_metadata;
 
       current_metadata = Metadata();
     }
-    if (buffer.atEnd()) {
+    if (reader.atEnd()) {
       break;
     }
-    line = QString::fromUtf8(buffer.readLine()).trimmed();
+    line = QString::fromUtf8(reader.ReadLine()).trimmed();
+  }
+
+  SongList ret = LoadSongs(entries, dir);
+  for (int i = 0; i < ret.count(); ++i) {
+    Song &song = ret[i];
+    const Metadata &metadata = entries_metadata[i];
+    if (!metadata.title.isEmpty()) {
+      song.set_title(metadata.title);
+    }
+    if (!metadata.artist.isEmpty()) {
+      song.set_artist(metadata.artist);
+    }
+    if (metadata.length > 0) {
+      song.set_length_nanosec(metadata.length);
+    }
   }
 
   return ret;
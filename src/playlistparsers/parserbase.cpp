@@ -22,8 +22,11 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QList>
+#include <QHash>
+#include <QPair>
 #include <QString>
-#include <QRegExp>
+#include <QStringList>
 #include <QUrl>
 
 #include "collection/collectionbackend.h"
@@ -34,15 +37,26 @@
 ParserBase::ParserBase(CollectionBackendInterface *collection, QObject *parent)
     : QObject(parent), collection_(collection) {}
 
-void ParserBase::LoadSong(const QString &filename_or_url, qint64 beginning, const QDir &dir, Song *song) const {
+const int ParserBase::kMaxPendingTagReads = 100;
+
+bool ParserBase::HasUrlScheme(const QString &filename_or_url) {
+
+  // Same as matching ^[a-z]{2,}: but without building a regular expression for every line of the playlist
+  int i = 0;
+  while (i < filename_or_url.length() && filename_or_url[i] >= 'a' && filename_or_url[i] <= 'z') ++i;
+  return i >= 2 && i < filename_or_url.length() && filename_or_url[i] == ':';
+
+}
+
+QString ParserBase::ResolveFilename(const QString &filename_or_url, const QDir &dir, Song *song) const {
 
   if (filename_or_url.isEmpty()) {
-    return;
+    return QString();
   }
 
   QString filename = filename_or_url;
 
-  if (filename_or_url.contains(QRegExp("^[a-z]{2,}:"))) {
+  if (HasUrlScheme(filename_or_url)) {
     QUrl url(filename_or_url);
     song->set_source(Song::SourceFromURL(url));
     if (song->source() == Song::Source_LocalFile) {
@@ -52,7 +66,7 @@ void ParserBase::LoadSong(const QString &filename_or_url, qint64 beginning, cons
       song->set_url(QUrl::fromUserInput(filename_or_url));
       song->set_filetype(Song::FileType_Stream);
       song->set_valid(true);
-      return;
+      return QString();
     }
     else {
       qLog(Error) << "Don't know how to handle" << url;
@@ -68,11 +82,21 @@ void ParserBase::LoadSong(const QString &filename_or_url, qint64 beginning, cons
     filename = dir.absoluteFilePath(filename);
   }
 
-  // Use the canonical path
-  if (QFile::exists(filename)) {
-    filename = QFileInfo(filename).canonicalFilePath();
+  // Use the canonical path, this is empty if the file doesn't exist
+  const QString canonical_filename = QFileInfo(filename).canonicalFilePath();
+  if (!canonical_filename.isEmpty()) {
+    filename = canonical_filename;
   }
 
+  return filename;
+
+}
+
+void ParserBase::LoadSong(const QString &filename_or_url, qint64 beginning, const QDir &dir, Song *song) const {
+
+  const QString filename = ResolveFilename(filename_or_url, dir, song);
+  if (filename.isEmpty()) return;
+
   const QUrl url = QUrl::fromLocalFile(filename);
 
   // Search in the collection
@@ -91,6 +115,65 @@ void ParserBase::LoadSong(const QString &filename_or_url, qint64 beginning, cons
 
 }
 
+SongList ParserBase::LoadSongs(const QList<SongEntry> &entries, const QDir &dir) const {
+
+  SongList songs;
+  QStringList filenames;
+  QList<QUrl> urls;
+  songs.reserve(entries.count());
+  filenames.reserve(entries.count());
+
+  for (const SongEntry &entry : entries) {
+    Song song;
+    const QString filename = ResolveFilename(entry.filename_or_url, dir, &song);
+    if (!filename.isEmpty()) {
+      urls << QUrl::fromLocalFile(filename);
+    }
+    songs << song;
+    filenames << filename;
+  }
+
+  // Search for all the files in the collection at once
+  QHash<QPair<QString, qint64>, Song> collection_songs;
+  if (collection_ && !urls.isEmpty()) {
+    for (const Song &collection_song : collection_->GetSongsByUrls(urls)) {
+      collection_songs.insert(qMakePair(collection_song.url().toString(), collection_song.beginning_nanosec()), collection_song);
+    }
+  }
+
+  QList<int> misses;
+  for (int i = 0; i < entries.count(); ++i) {
+    if (filenames[i].isEmpty()) continue;
+    const QPair<QString, qint64> key = qMakePair(QUrl::fromLocalFile(filenames[i]).toString(), entries[i].beginning);
+    if (collection_songs.contains(key)) {
+      songs[i] = collection_songs[key];
+    }
+    else {
+      misses << i;
+    }
+  }
+
+  // Load metadata from disk for the rest.
+  // Send a batch of requests before waiting for any of them so all the tagreader workers are kept busy.
+  for (int i = 0; i < misses.count(); i += kMaxPendingTagReads) {
+    const int end = qMin(misses.count(), i + kMaxPendingTagReads);
+    QList<TagReaderReply*> replies;
+    for (int j = i; j < end; ++j) {
+      replies << TagReaderClient::Instance()->ReadFile(filenames[misses[j]]);
+    }
+    for (int j = i; j < end; ++j) {
+      TagReaderReply *reply = replies[j - i];
+      if (reply->WaitForFinished()) {
+        songs[misses[j]].InitFromProtobuf(reply->message().read_file_response().metadata());
+      }
+      reply->deleteLater();
+    }
+  }
+
+  return songs;
+
+}
+
 Song ParserBase::LoadSong(const QString &filename_or_url, qint64 beginning, const QDir &dir) const {
 
   Song song;
@@ -28,6 +28,7 @@
 #include <QIODevice>
 #include <QDir>
 #include <QByteArray>
+#include <QList>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
@@ -59,6 +60,14 @@ class ParserBase : public QObject {
   virtual void Save(const SongList &songs, QIODevice *device, const QDir &dir = QDir(), Playlist::Path path_type = Playlist::Path_Automatic) const = 0;
 
 protected:
+  // A song reference found in a playlist, to be resolved by LoadSongs().
+  struct SongEntry {
+    SongEntry(const QString &_filename_or_url = QString(), const qint64 _beginning = 0) : filename_or_url(_filename_or_url), beginning(_beginning) {}
+
+    QString filename_or_url;
+    qint64 beginning;
+  };
+
   // Loads a song.  If filename_or_url is a URL (with a scheme other than "file") then it is set on the song and the song marked as a stream.
   // If it is a filename or a file:// URL then it is made absolute and canonical and set as a file:// url on the song.
   // Also sets the song's metadata by searching in the Collection, or loading from the file as a fallback.
@@ -66,11 +75,22 @@ protected:
   Song LoadSong(const QString &filename_or_url, qint64 beginning, const QDir &dir) const;
   void LoadSong(const QString &filename_or_url, qint64 beginning, const QDir &dir, Song *song) const;
 
+  // Does the same as LoadSong for a whole playlist at once, which is what parsers should use when they have more than a few entries.
+  // The collection is searched for all the files with one query, and the files that are not in the collection are read by the tagreader workers in parallel.
+  // Returns one song for each entry, in the same order.
+  SongList LoadSongs(const QList<SongEntry> &entries, const QDir &dir) const;
+
   // If the URL is a file:// URL then returns its path, absolute or relative to the directory depending on the path_type option.
   // Otherwise returns the URL as is. This function should always be used when saving a playlist.
   QString URLOrFilename(const QUrl &url, const QDir &dir, Playlist::Path path_type) const;
 
 private:
+  static const int kMaxPendingTagReads;
+
+  // Makes filename_or_url absolute and canonical.  Returns an empty string if there's no file to look up, the song is complete already in that case.
+  QString ResolveFilename(const QString &filename_or_url, const QDir &dir, Song *song) const;
+  static bool HasUrlScheme(const QString &filename_or_url);
+
   CollectionBackendInterface *collection_;
 };
 
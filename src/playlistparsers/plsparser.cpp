@@ -31,6 +31,7 @@
 #include "core/timeconstants.h"
 #include "playlistparsers/parserbase.h"
 #include "plsparser.h"
+#include "linereader.h"
 
 class CollectionBackendInterface;
 
@@ -40,10 +41,12 @@ PLSParser::PLSParser(CollectionBackendInterface *collection, QObject *parent)
 SongList PLSParser::Load(QIODevice *device, const QString &playlist_path, const QDir &dir) const {
 
   QMap<int, Song> songs;
+  QMap<int, QString> files;
   QRegExp n_re("\\d+$");
 
-  while (!device->atEnd()) {
-    QString line = QString::fromUtf8(device->readLine()).trimmed();
+  LineReader reader(device);
+  while (!reader.atEnd()) {
+    QString line = QString::fromUtf8(reader.ReadLine()).trimmed();
     int equals = line.indexOf('=');
     QString key = line.left(equals).toLower();
     QString value = line.mid(equals + 1);
@@ -52,14 +55,7 @@ SongList PLSParser::Load(QIODevice *device, const QString &playlist_path, const
     int n = n_re.cap(0).toInt();
 
     if (key.startsWith("file")) {
-      Song song = LoadSong(value, 0, dir);
-
-      // Use the title and length we've already loaded if any
-      if (!songs[n].title().isEmpty()) song.set_title(songs[n].title());
-      if (songs[n].length_nanosec() != -1)
-        song.set_length_nanosec(songs[n].length_nanosec());
-
-      songs[n] = song;
+      files[n] = value;
     }
     else if (key.startsWith("title")) {
       songs[n].set_title(value);
@@ -72,6 +68,23 @@ SongList PLSParser::Load(QIODevice *device, const QString &playlist_path, const
     }
   }
 
+  // Load all the files at once, then use the title and length from the playlist if any
+  QList<int> numbers;
+  QList<SongEntry> entries;
+  for (QMap<int, QString>::const_iterator it = files.constBegin(); it != files.constEnd(); ++it) {
+    numbers << it.key();
+    entries << SongEntry(it.value());
+  }
+
+  SongList loaded_songs = LoadSongs(entries, dir);
+  for (int i = 0; i < numbers.count(); ++i) {
+    const Song &playlist_song = songs[numbers[i]];
+    Song &song = loaded_songs[i];
+    if (!playlist_song.title().isEmpty()) song.set_title(playlist_song.title());
+    if (playlist_song.length_nanosec() != -1) song.set_length_nanosec(playlist_song.length_nanosec());
+    songs[numbers[i]] = song;
+  }
+
   return songs.values();
 
 }
@@ -49,14 +49,21 @@ SongList WplParser::Load(QIODevice *device, const QString &playlist_path, const
     return ret;
   }
 
+  QList<SongEntry> entries;
   while (!reader.atEnd() && Utilities::ParseUntilElement(&reader, "seq")) {
-    ParseSeq(dir, &reader, &ret);
+    ParseSeq(&reader, &entries);
+  }
+
+  for (const Song &song : LoadSongs(entries, dir)) {
+    if (song.is_valid()) {
+      ret << song;
+    }
   }
   return ret;
 
 }
 
-void WplParser::ParseSeq(const QDir &dir, QXmlStreamReader *reader, SongList *songs) const {
+void WplParser::ParseSeq(QXmlStreamReader *reader, QList<SongEntry> *entries) const {
 
   while (!reader->atEnd()) {
     QXmlStreamReader::TokenType type = reader->readNext();
@@ -66,10 +73,7 @@ void WplParser::ParseSeq(const QDir &dir, QXmlStreamReader *reader, SongList *so
         if (name == "media") {
           QStringRef src = reader->attributes().value("src");
           if (!src.isEmpty()) {
-            Song song = LoadSong(src.toString(), 0, dir);
-            if (song.is_valid()) {
-              songs->append(song);
-            }
+            entries->append(SongEntry(src.toString()));
           }
         } else {
           Utilities::ConsumeCurrentElement(reader);
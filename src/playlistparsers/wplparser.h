@@ -53,7 +53,7 @@ class WplParser : public XMLParser {
   void Save(const SongList &songs, QIODevice *device, const QDir &dir, Playlist::Path path_type = Playlist::Path_Automatic) const;
 
 private:
-  void ParseSeq(const QDir &dir, QXmlStreamReader *reader, SongList *songs) const;
+  void ParseSeq(QXmlStreamReader *reader, QList<SongEntry> *entries) const;
   void WriteMeta(const QString &name, const QString &content, QXmlStreamWriter *writer) const;
 };
 
@@ -50,8 +50,26 @@ SongList XSPFParser::Load(QIODevice *device, const QString &playlist_path, const
     return ret;
   }
 
+  QList<SongEntry> entries;
+  SongList playlist_songs;
   while (!reader.atEnd() && Utilities::ParseUntilElement(&reader, "track")) {
-    Song song = ParseTrack(&reader, dir);
+    QString location;
+    playlist_songs << ParseTrack(&reader, &location);
+    entries << SongEntry(location);
+  }
+
+  SongList songs = LoadSongs(entries, dir);
+  for (int i = 0; i < songs.count(); ++i) {
+    Song &song = songs[i];
+    const Song &playlist_song = playlist_songs[i];
+
+    // Override metadata with what was in the playlist
+    song.set_title(playlist_song.title());
+    song.set_artist(playlist_song.artist());
+    song.set_album(playlist_song.album());
+    song.set_length_nanosec(playlist_song.length_nanosec());
+    song.set_track(playlist_song.track());
+
     if (song.is_valid()) {
       ret << song;
     }
@@ -60,9 +78,9 @@ SongList XSPFParser::Load(QIODevice *device, const QString &playlist_path, const
 
 }
 
-Song XSPFParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir) const {
+Song XSPFParser::ParseTrack(QXmlStreamReader *reader, QString *location) const {
 
-  QString title, artist, album, location;
+  QString title, artist, album;
   qint64 nanosec = -1;
   int track_num = -1;
 
@@ -72,7 +90,7 @@ Song XSPFParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir) const {
       case QXmlStreamReader::StartElement: {
         QStringRef name = reader->name();
         if (name == "location") {
-          location = reader->readElementText();
+          *location = reader->readElementText();
         }
         else if (name == "title") {
           title = reader->readElementText();
@@ -118,9 +136,8 @@ Song XSPFParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir) const {
   }
 
 return_song:
-  Song song = LoadSong(location, 0, dir);
-
-  // Override metadata with what was in the playlist
+  // Only the metadata from the playlist, the song itself is loaded later
+  Song song;
   song.set_title(title);
   song.set_artist(artist);
   song.set_album(album);
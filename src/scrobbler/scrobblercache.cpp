@@ -25,8 +25,12 @@
 #include <QStandardPaths>
 #include <QString>
 #include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
 #include <QIODevice>
 #include <QTextStream>
+#include <QDataStream>
+#include <QByteArray>
 #include <QHash>
 #include <QJsonDocument>
 #include <QJsonValue>
@@ -41,18 +45,128 @@
 #include "scrobblercache.h"
 #include "scrobblercacheitem.h"
 
+const quint32 ScrobblerCache::kJournalMagic = 0x53425343;
+const quint32 ScrobblerCache::kJournalVersion = 1;
+const int ScrobblerCache::kCompactMinRecords = 500;
+
 ScrobblerCache::ScrobblerCache(const QString &filename, QObject *parent) :
   QObject(parent),
   filename_(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + filename),
-  loaded_(false) {
+  journal_filename_(filename_ + ".journal"),
+  loaded_(false),
+  journal_readonly_(false),
+  dead_records_(0) {
   ReadCache();
   loaded_ = true;
 }
 
-ScrobblerCache::~ScrobblerCache() {}
+ScrobblerCache::~ScrobblerCache() {
+  journal_.close();
+}
 
 void ScrobblerCache::ReadCache() {
 
+  if (QFile::exists(journal_filename_)) {
+    // Rewrite the journal straight away if it ends in a partial record, so new records are not appended after it.
+    if (ReadJournal()) MaybeCompact();
+    else Compact();
+  }
+  else if (QFile::exists(filename_)) {
+    qLog(Debug) << "Migrating scrobbler cache" << filename_ << "to" << journal_filename_;
+    ReadJsonCache();
+    Compact();
+    if (journal_.isOpen()) QFile::remove(filename_);
+  }
+
+}
+
+bool ScrobblerCache::ReadJournal() {
+
+  QFile file(journal_filename_);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qLog(Error) << "Unable to open scrobbler cache journal" << journal_filename_;
+    return true;
+  }
+  const QByteArray data = file.readAll();
+  file.close();
+
+  QDataStream stream(data);
+  stream.setVersion(QDataStream::Qt_5_5);
+
+  quint32 magic = 0;
+  quint32 version = 0;
+  stream >> magic >> version;
+  if (stream.status() != QDataStream::Ok || magic != kJournalMagic || version != kJournalVersion) {
+    qLog(Error) << "Scrobbler cache journal" << journal_filename_ << "has an unknown format.";
+    return false;
+  }
+
+  int records = 0;
+  while (!stream.atEnd()) {
+    QByteArray record;
+    stream >> record;
+    if (stream.status() != QDataStream::Ok) {
+      qLog(Error) << "Scrobbler cache journal" << journal_filename_ << "ends with a truncated record.";
+      return false;
+    }
+
+    QDataStream record_stream(record);
+    record_stream.setVersion(QDataStream::Qt_5_5);
+    quint8 type = 0;
+    quint64 timestamp = 0;
+    record_stream >> type >> timestamp;
+
+    if (type == Record_Add) {
+      QString artist;
+      QString album;
+      QString song;
+      QString albumartist;
+      qint32 track = 0;
+      qint64 duration = 0;
+      record_stream >> artist >> album >> song >> albumartist >> track >> duration;
+      if (record_stream.status() != QDataStream::Ok) {
+        qLog(Error) << "Scrobbler cache journal" << journal_filename_ << "has an invalid record.";
+        BackupJournal();
+        return false;
+      }
+      ++records;
+      if (scrobbler_cache_.contains(timestamp)) continue;
+      ScrobblerCacheItem *item = new ScrobblerCacheItem(artist, album, song, albumartist, track, duration, timestamp);
+      scrobbler_cache_.insert(timestamp, item);
+    }
+    else if (type == Record_Remove && record_stream.status() == QDataStream::Ok) {
+      ++records;
+      delete scrobbler_cache_.take(timestamp);
+    }
+    else {
+      qLog(Error) << "Scrobbler cache journal" << journal_filename_ << "has an invalid record.";
+      BackupJournal();
+      return false;
+    }
+  }
+
+  dead_records_ = records - scrobbler_cache_.size();
+
+  return true;
+
+}
+
+void ScrobblerCache::BackupJournal() {
+
+  // Keep the records we could not read, the next compaction replaces the journal with only the ones we could.
+  const QString backup_filename = journal_filename_ + "." + QDateTime::currentDateTime().toString("yyyyMMddhhmmss") + ".bak";
+  if (QFile::rename(journal_filename_, backup_filename)) {
+    qLog(Error) << "Moved unreadable scrobbler cache journal to" << backup_filename;
+  }
+  else {
+    qLog(Error) << "Unable to move unreadable scrobbler cache journal" << journal_filename_ << "to" << backup_filename << "- keeping scrobbles in memory only.";
+    journal_readonly_ = true;
+  }
+
+}
+
+void ScrobblerCache::ReadJsonCache() {
+
   QFile file(filename_);
   bool result = file.open(QIODevice::ReadOnly | QIODevice::Text);
   if (!result) return;
@@ -138,42 +252,105 @@ void ScrobblerCache::ReadCache() {
 
 }
 
+bool ScrobblerCache::OpenJournal() {
+
+  if (journal_readonly_) return false;
+
+  journal_.setFileName(journal_filename_);
+  if (!journal_.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    qLog(Error) << "Unable to open scrobbler cache journal" << journal_filename_;
+    return false;
+  }
+
+  if (journal_.size() == 0) {
+    QDataStream stream(&journal_);
+    stream.setVersion(QDataStream::Qt_5_5);
+    stream << kJournalMagic << kJournalVersion;
+  }
+
+  return true;
+
+}
+
+QByteArray ScrobblerCache::AddRecord(const ScrobblerCacheItem &item) {
+
+  QByteArray record;
+  QDataStream stream(&record, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_5_5);
+  stream << quint8(Record_Add) << item.timestamp_ << item.artist_ << item.album_ << item.song_ << item.albumartist_ << qint32(item.track_) << item.duration_;
+  return record;
+
+}
+
+void ScrobblerCache::AppendRecord(const QByteArray &record) {
+
+  if (!journal_.isOpen() && !OpenJournal()) return;
+
+  QDataStream stream(&journal_);
+  stream.setVersion(QDataStream::Qt_5_5);
+  stream << record;
+  if (stream.status() != QDataStream::Ok || !journal_.flush()) {
+    qLog(Error) << "Unable to write to scrobbler cache journal" << journal_filename_;
+  }
+
+}
+
+void ScrobblerCache::AppendRemove(const quint64 timestamp) {
+
+  QByteArray record;
+  QDataStream stream(&record, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_5_5);
+  stream << quint8(Record_Remove) << timestamp;
+  AppendRecord(record);
+
+  // The removal and the add it cancels are both dead now.
+  dead_records_ += 2;
+
+}
+
+bool ScrobblerCache::CompactionDue() const {
+  return dead_records_ >= kCompactMinRecords && dead_records_ > scrobbler_cache_.size();
+}
+
+void ScrobblerCache::MaybeCompact() {
+  if (CompactionDue()) DoInAMinuteOrSo(this, SLOT(Compact()));
+}
+
 void ScrobblerCache::WriteCache() {
 
-  if (!loaded_) return;
+  // Records are appended as they happen, so there is only something left to do if the journal is due to be compacted.
+  if (CompactionDue()) Compact();
+
+}
+
+void ScrobblerCache::Compact() {
 
-  qLog(Debug) << "Writing scrobbler cache file" << filename_;
+  if (journal_readonly_) return;
 
-  QJsonArray array;
+  qLog(Debug) << "Writing scrobbler cache journal" << journal_filename_;
 
-  QHash <quint64, ScrobblerCacheItem*> ::iterator i;
-  for (i = scrobbler_cache_.begin() ; i != scrobbler_cache_.end() ; ++i) {
-    ScrobblerCacheItem *item = i.value();
-    QJsonObject object;
-    object.insert("timestamp", QJsonValue::fromVariant(item->timestamp_));
-    object.insert("artist", QJsonValue::fromVariant(item->artist_));
-    object.insert("album", QJsonValue::fromVariant(item->album_));
-    object.insert("song", QJsonValue::fromVariant(item->song_));
-    object.insert("albumartist", QJsonValue::fromVariant(item->albumartist_));
-    object.insert("track", QJsonValue::fromVariant(item->track_));
-    object.insert("duration", QJsonValue::fromVariant(item->duration_));
-    array.append(QJsonValue::fromVariant(object));
+  journal_.close();
+
+  QSaveFile file(journal_filename_);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qLog(Error) << "Unable to open scrobbler cache journal" << journal_filename_;
+    return;
   }
 
-  QJsonObject object;
-  object.insert("tracks", array);
-  QJsonDocument doc(object);
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_5);
+  stream << kJournalMagic << kJournalVersion;
+  for (ScrobblerCacheItem *item : List()) {
+    stream << AddRecord(*item);
+  }
 
-  QFile file(filename_);
-  bool result = file.open(QIODevice::WriteOnly | QIODevice::Text);
-  if (!result) {
-    qLog(Error) << "Unable to open scrobbler cache file" << filename_;
+  if (!file.commit()) {
+    qLog(Error) << "Unable to write scrobbler cache journal" << journal_filename_;
     return;
   }
-  QTextStream stream(&file);
-  stream.setCodec("UTF-8");
-  stream << doc.toJson();
-  file.close();
+
+  dead_records_ = 0;
+  OpenJournal();
 
 }
 
@@ -191,7 +368,7 @@ ScrobblerCacheItem *ScrobblerCache::Add(const Song &song, const quint64 &timesta
   ScrobblerCacheItem *item = new ScrobblerCacheItem(song.artist(), album, title, song.albumartist(), song.track(), song.length_nanosec(), timestamp);
   scrobbler_cache_.insert(timestamp, item);
 
-  if (loaded_) DoInAMinuteOrSo(this, SLOT(WriteCache()));
+  if (loaded_) AppendRecord(AddRecord(*item));
 
   return item;
 
@@ -212,18 +389,19 @@ void ScrobblerCache::Remove(const quint64 hash) {
   }
 
   delete scrobbler_cache_.take(hash);
+  AppendRemove(hash);
+  MaybeCompact();
 
 }
 
 void ScrobblerCache::Remove(ScrobblerCacheItem &item) {
-  delete scrobbler_cache_.take(item.timestamp_);
+  Remove(item.timestamp_);
 }
 
 void ScrobblerCache::ClearSent(const QList<quint64> list) {
   for (quint64 timestamp : list) {
     if (!scrobbler_cache_.contains(timestamp)) continue;
-    ScrobblerCacheItem *item = scrobbler_cache_.take(timestamp);
-    item->sent_ = false;
+    scrobbler_cache_.value(timestamp)->sent_ = false;
   }
 }
 
@@ -232,7 +410,8 @@ void ScrobblerCache::Flush(const QList<quint64> list) {
   for (quint64 timestamp : list) {
     if (!scrobbler_cache_.contains(timestamp)) continue;
     delete scrobbler_cache_.take(timestamp);
+    AppendRemove(timestamp);
   }
-  DoInAMinuteOrSo(this, SLOT(WriteCache()));
+  MaybeCompact();
 
 }
@@ -24,10 +24,14 @@
 
 #include <stdbool.h>
 
+#include <QtGlobal>
 #include <QObject>
 #include <QList>
 #include <QHash>
 #include <QString>
+#include <QFile>
+
+class QByteArray;
 
 class Song;
 class ScrobblerCacheItem;
@@ -52,10 +56,35 @@ class ScrobblerCache : public QObject {
 
  public slots:
   void WriteCache();
+  void Compact();
+
+ private:
+  enum RecordType {
+    Record_Add = 1,
+    Record_Remove = 2,
+  };
+
+  static const quint32 kJournalMagic;
+  static const quint32 kJournalVersion;
+  static const int kCompactMinRecords;
+
+  bool ReadJournal();
+  void BackupJournal();
+  void ReadJsonCache();
+  bool OpenJournal();
+  void AppendRecord(const QByteArray &record);
+  void AppendRemove(const quint64 timestamp);
+  bool CompactionDue() const;
+  void MaybeCompact();
+  static QByteArray AddRecord(const ScrobblerCacheItem &item);
 
  private:
   QString filename_;
+  QString journal_filename_;
   bool loaded_;
+  bool journal_readonly_;
+  QFile journal_;
+  int dead_records_;
   QHash <quint64, ScrobblerCacheItem*> scrobbler_cache_;
 
 };
@@ -0,0 +1,201 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <cstring>
+
+#include <QObject>
+#include <QPair>
+#include <QList>
+#include <QHash>
+#include <QQueue>
+#include <QPointer>
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QDateTime>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+#include "core/closure.h"
+#include "core/logging.h"
+#include "core/network.h"
+#include "tidalrequestcache.h"
+
+const int TidalRequestCache::kMaxAge = 600;  // seconds
+const qint64 TidalRequestCache::kMaxSize = 16 * 1024 * 1024;  // bytes
+const int TidalRequestCache::kMaxParallelRequests = 4;
+
+TidalCachedReply::TidalCachedReply(const QNetworkRequest &request, QObject *parent)
+    : QNetworkReply(parent),
+      offset_(0) {
+
+  setRequest(request);
+  setUrl(request.url());
+  setOperation(QNetworkAccessManager::GetOperation);
+  open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+}
+
+void TidalCachedReply::Finish(const QNetworkReply::NetworkError error, const QString &error_string, const QVariant &http_status, const QByteArray &data) {
+
+  data_ = data;
+  offset_ = 0;
+  if (error != QNetworkReply::NoError) setError(error, error_string);
+  if (http_status.isValid()) setAttribute(QNetworkRequest::HttpStatusCodeAttribute, http_status);
+
+  // Callers connect to finished() after Get() returns, so always emit it from the event loop.
+  metaObject()->invokeMethod(this, "EmitFinished", Qt::QueuedConnection);
+
+}
+
+void TidalCachedReply::EmitFinished() {
+
+  setFinished(true);
+  if (!data_.isEmpty()) emit readyRead();
+  emit finished();
+
+}
+
+void TidalCachedReply::abort() {}
+
+qint64 TidalCachedReply::bytesAvailable() const {
+  return data_.size() - offset_ + QIODevice::bytesAvailable();
+}
+
+qint64 TidalCachedReply::readData(char *data, qint64 maxlen) {
+
+  if (offset_ >= data_.size()) return -1;
+
+  qint64 count = qMin(maxlen, data_.size() - offset_);
+  std::memcpy(data, data_.constData() + offset_, count);
+  offset_ += count;
+  return count;
+
+}
+
+TidalRequestCache::TidalRequestCache(NetworkAccessManager *network, QObject *parent)
+    : QObject(parent),
+      network_(network),
+      cache_size_(0),
+      requests_active_(0) {}
+
+QNetworkReply *TidalRequestCache::Get(const QNetworkRequest &req, const QString &key) {
+
+  TidalCachedReply *reply = new TidalCachedReply(req, this);
+
+  if (cache_.contains(key)) {
+    const CacheEntry &entry = cache_[key];
+    if (QDateTime::currentMSecsSinceEpoch() - entry.time < qint64(kMaxAge) * 1000) {
+      reply->Finish(QNetworkReply::NoError, QString(), 200, entry.data);
+      return reply;
+    }
+    Remove(key);
+  }
+
+  // Identical requests share one network request.
+  if (waiting_.contains(key)) {
+    waiting_[key] << reply;
+    return reply;
+  }
+
+  waiting_[key] << reply;
+  queue_.enqueue(qMakePair(key, req));
+  StartRequests();
+
+  return reply;
+
+}
+
+void TidalRequestCache::StartRequests() {
+
+  while (requests_active_ < kMaxParallelRequests && !queue_.isEmpty()) {
+    QPair<QString, QNetworkRequest> request = queue_.dequeue();
+    QNetworkReply *reply = network_->get(request.second);
+    NewClosure(reply, SIGNAL(finished()), this, SLOT(RequestFinished(QNetworkReply*, QString)), reply, request.first);
+    ++requests_active_;
+  }
+
+}
+
+void TidalRequestCache::RequestFinished(QNetworkReply *reply, const QString key) {
+
+  reply->deleteLater();
+  --requests_active_;
+
+  QByteArray data = reply->readAll();
+  if (reply->error() == QNetworkReply::NoError) Insert(key, data);
+
+  for (QPointer<TidalCachedReply> waiting_reply : waiting_.take(key)) {
+    if (waiting_reply) waiting_reply->Finish(reply->error(), reply->errorString(), reply->attribute(QNetworkRequest::HttpStatusCodeAttribute), data);
+  }
+
+  StartRequests();
+
+}
+
+void TidalRequestCache::AbortQueued() {
+
+  while (!queue_.isEmpty()) {
+    QString key = queue_.dequeue().first;
+    for (QPointer<TidalCachedReply> waiting_reply : waiting_.take(key)) {
+      if (waiting_reply) waiting_reply->Finish(QNetworkReply::OperationCanceledError, "Operation canceled", QVariant(), QByteArray());
+    }
+  }
+
+}
+
+void TidalRequestCache::Clear() {
+
+  cache_.clear();
+  cache_order_.clear();
+  cache_size_ = 0;
+
+}
+
+void TidalRequestCache::Insert(const QString &key, const QByteArray &data) {
+
+  if (data.size() > kMaxSize) return;
+
+  Remove(key);
+
+  CacheEntry entry;
+  entry.data = data;
+  entry.time = QDateTime::currentMSecsSinceEpoch();
+  cache_.insert(key, entry);
+  cache_order_ << key;
+  cache_size_ += data.size();
+
+  // Entries are ordered by age, so expired entries and entries above the size limit are at the front.
+  const qint64 expired = entry.time - qint64(kMaxAge) * 1000;
+  while (!cache_order_.isEmpty() && (cache_size_ > kMaxSize || cache_[cache_order_.first()].time <= expired)) {
+    Remove(cache_order_.first());
+  }
+
+}
+
+void TidalRequestCache::Remove(const QString &key) {
+
+  if (!cache_.contains(key)) return;
+
+  cache_size_ -= cache_.take(key).data.size();
+  cache_order_.removeOne(key);
+
+}
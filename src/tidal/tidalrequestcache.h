@@ -0,0 +1,108 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TIDALREQUESTCACHE_H
+#define TIDALREQUESTCACHE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QPair>
+#include <QList>
+#include <QHash>
+#include <QQueue>
+#include <QPointer>
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+class NetworkAccessManager;
+
+// Reply handed out by TidalRequestCache.
+// It is finished with the data of a cached response or of a network reply that might be shared with other callers.
+class TidalCachedReply : public QNetworkReply {
+  Q_OBJECT
+
+ public:
+  explicit TidalCachedReply(const QNetworkRequest &request, QObject *parent = nullptr);
+
+  void Finish(const QNetworkReply::NetworkError error, const QString &error_string, const QVariant &http_status, const QByteArray &data);
+
+  void abort();
+  qint64 bytesAvailable() const;
+  bool isSequential() const { return true; }
+
+ protected:
+  qint64 readData(char *data, qint64 maxlen);
+
+ private slots:
+  void EmitFinished();
+
+ private:
+  QByteArray data_;
+  qint64 offset_;
+
+};
+
+// Caches successful GET responses for a limited time, merges identical requests that are in flight and limits the number of parallel requests.
+class TidalRequestCache : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit TidalRequestCache(NetworkAccessManager *network, QObject *parent = nullptr);
+
+  static const int kMaxAge;
+  static const qint64 kMaxSize;
+  static const int kMaxParallelRequests;
+
+  // key identifies the response, it should not contain anything specific to the session.
+  QNetworkReply *Get(const QNetworkRequest &req, const QString &key);
+
+  // Finish replies that are still waiting for a free slot with OperationCanceledError.
+  void AbortQueued();
+  void Clear();
+
+ private slots:
+  void RequestFinished(QNetworkReply *reply, const QString key);
+
+ private:
+  struct CacheEntry {
+    CacheEntry() : time(0) {}
+    QByteArray data;
+    qint64 time;
+  };
+
+  void StartRequests();
+  void Insert(const QString &key, const QByteArray &data);
+  void Remove(const QString &key);
+
+  NetworkAccessManager *network_;
+  QHash<QString, CacheEntry> cache_;
+  QList<QString> cache_order_;
+  qint64 cache_size_;
+  QHash<QString, QList<QPointer<TidalCachedReply>>> waiting_;
+  QQueue<QPair<QString, QNetworkRequest>> queue_;
+  int requests_active_;
+
+};
+
+#endif  // TIDALREQUESTCACHE_H
@@ -53,11 +53,11 @@
 #include "internet/internetsearch.h"
 #include "tidalservice.h"
 #include "tidalurlhandler.h"
+#include "tidalrequestcache.h"
 #include "settings/tidalsettingspage.h"
 
 const Song::Source TidalService::kSource = Song::Source_Tidal;
 const char *TidalService::kApiUrl = "https://listen.tidal.com/v1";
-const char *TidalService::kAuthUrl = "https://listen.tidal.com/v1/login/username";
 const char *TidalService::kResourcesUrl = "http://resources.tidal.com";
 const char *TidalService::kApiTokenB64 = "UDVYYmVvNUxGdkVTZUR5Ng==";
 const int TidalService::kLoginAttempts = 1;
@@ -68,8 +68,10 @@ TidalService::TidalService(Application *app, QObject *parent)
       app_(app),
       network_(new NetworkAccessManager(this)),
       url_handler_(new TidalUrlHandler(app, this)),
+      cache_(new TidalRequestCache(network_, this)),
       timer_search_delay_(new QTimer(this)),
       timer_login_attempt_(new QTimer(this)),
+      api_url_(Utilities::GetEnv("STRAWBERRY_TIDAL_API_URL")),
       search_delay_(1500),
       artistssearchlimit_(1),
       albumssearchlimit_(1),
@@ -84,10 +86,13 @@ TidalService::TidalService(Application *app, QObject *parent)
       artist_albums_received_(0),
       album_songs_requested_(0),
       album_songs_received_(0),
+      search_truncated_(false),
       login_sent_(false),
       login_attempts_(0)
   {
 
+  if (api_url_.isEmpty()) api_url_ = kApiUrl;
+
   timer_search_delay_->setSingleShot(true);
   connect(timer_search_delay_, SIGNAL(timeout()), SLOT(StartSearch()));
 
@@ -176,7 +181,7 @@ void TidalService::SendLogin(const QString &username, const QString &password) {
     url_query.addQueryItem(encoded_arg.first, encoded_arg.second);
   }
 
-  QUrl url(kAuthUrl);
+  QUrl url(api_url_ + QString("/login/username"));
   QNetworkRequest req(url);
 
   req.setRawHeader("Origin", "http://listen.tidal.com");
@@ -284,6 +289,7 @@ void TidalService::Logout() {
   user_id_ = 0;
   session_id_.clear();
   country_code_.clear();
+  cache_->Clear();
 
   QSettings s;
   s.beginGroup(TidalSettingsPage::kSettingsGroup);
@@ -298,7 +304,7 @@ void TidalService::ResetLoginAttempts() {
   login_attempts_ = 0;
 }
 
-QNetworkReply *TidalService::CreateRequest(const QString &ressource_name, const QList<Param> &params) {
+QNetworkReply *TidalService::CreateRequest(const QString &ressource_name, const QList<Param> &params, const bool cache) {
 
   typedef QPair<QString, QString> Arg;
   typedef QList<Arg> ArgList;
@@ -318,12 +324,23 @@ QNetworkReply *TidalService::CreateRequest(const QString &ressource_name, const
     url_query.addQueryItem(encoded_arg.first, encoded_arg.second);
   }
 
-  QUrl url(kApiUrl + QString("/") + ressource_name);
+  QUrl url(api_url_ + QString("/") + ressource_name);
   url.setQuery(url_query);
   QNetworkRequest req(url);
   req.setRawHeader("Origin", "http://listen.tidal.com");
   req.setRawHeader("X-Tidal-SessionId", session_id_.toUtf8());
-  QNetworkReply *reply = network_->get(req);
+
+  QNetworkReply *reply = nullptr;
+  if (cache) {
+    // The response does not depend on the session, so leave the session id out of the cache key.
+    QUrlQuery key_query;
+    for (const Arg &arg : params) key_query.addQueryItem(arg.first, arg.second);
+    key_query.addQueryItem("countryCode", country_code_);
+    reply = cache_->Get(req, ressource_name + "?" + key_query.toString(QUrl::FullyEncoded));
+  }
+  else {
+    reply = network_->get(req);
+  }
 
   //qLog(Debug) << "Tidal: Sending request" << url;
 
@@ -484,9 +501,11 @@ void TidalService::ClearSearch() {
   artist_albums_received_ = 0;
   album_songs_requested_ = 0;
   album_songs_received_ = 0;
+  search_truncated_ = false;
   requests_artist_albums_.clear();
   requests_album_songs_.clear();
   songs_.clear();
+  cache_->AbortQueued();
 
 }
 
@@ -571,6 +590,9 @@ void TidalService::ArtistsReceived(QNetworkReply *reply, int search_id) {
     return;
   }
 
+  // The search limit was reached, there could be more matching artists.
+  if (json_items.count() >= artistssearchlimit_) search_truncated_ = true;
+
   for (const QJsonValue &value : json_items) {
     if (!value.isObject()) {
       qLog(Error) << "Tidal: Invalid Json reply, item not a object.";
@@ -590,7 +612,10 @@ void TidalService::ArtistsReceived(QNetworkReply *reply, int search_id) {
     requests_artist_albums_.append(artist_id);
     GetAlbums(artist_id);
     artist_albums_requested_++;
-    if (artist_albums_requested_ >= artistssearchlimit_) break;
+    if (artist_albums_requested_ >= artistssearchlimit_) {
+      search_truncated_ = true;
+      break;
+    }
 
   }
 
@@ -673,6 +698,11 @@ void TidalService::AlbumsReceived(QNetworkReply *reply, int search_id, int artis
     return;
   }
 
+  // The albums or tracks search limit was reached, there could be more matches.
+  if (!artist_search_ && json_items.count() >= (pending_search_type_ == InternetSearch::SearchType_Songs ? songssearchlimit_ : albumssearchlimit_)) {
+    search_truncated_ = true;
+  }
+
   int albums = 0;
   for (const QJsonValue &value : json_items) {
      albums++;
@@ -750,7 +780,10 @@ void TidalService::AlbumsReceived(QNetworkReply *reply, int search_id, int artis
 
     requests_album_songs_.insert(album_id, artist);
     album_songs_requested_++;
-    if (album_songs_requested_ >= albumssearchlimit_) break;
+    if (album_songs_requested_ >= albumssearchlimit_) {
+      search_truncated_ = true;
+      break;
+    }
   }
 
   AlbumsFinished(artist_id, offset_requested, total_albums, limit, albums);
@@ -992,7 +1025,8 @@ void TidalService::GetStreamURL(const QUrl &url) {
   QList<Param> parameters;
   parameters << Param("soundQuality", quality_);
 
-  QNetworkReply *reply = CreateRequest(QString("tracks/%1/streamUrl").arg(song_id), parameters);
+  // Stream URLs expire, never serve them from the cache.
+  QNetworkReply *reply = CreateRequest(QString("tracks/%1/streamUrl").arg(song_id), parameters, false);
   NewClosure(reply, SIGNAL(finished()), this, SLOT(StreamURLReceived(QNetworkReply*, int, QUrl)), reply, song_id, url);
 
 }
@@ -1051,7 +1085,7 @@ void TidalService::CheckFinish() {
       if (search_error_.isEmpty()) emit SearchError(search_id_, "Unknown error");
       else emit SearchError(search_id_, search_error_);
     }
-    else emit SearchResults(search_id_, songs_);
+    else emit SearchResults(search_id_, songs_, search_truncated_);
     ClearSearch();
   }
 
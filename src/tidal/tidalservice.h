@@ -43,6 +43,7 @@
 class Application;
 class NetworkAccessManager;
 class TidalUrlHandler;
+class TidalRequestCache;
 
 class TidalService : public InternetService {
   Q_OBJECT
@@ -69,7 +70,8 @@ class TidalService : public InternetService {
   void Login(const QString &username, const QString &password);
   void LoginSuccess();
   void LoginFailure(QString failure_reason);
-  void SearchResults(int id, SongList songs);
+  // truncated is set when the service limits cut off results, so the songs are not all matches of the query.
+  void SearchResults(int id, SongList songs, bool truncated);
   void SearchError(int id, QString message);
   void UpdateStatus(QString text);
   void ProgressSetMaximum(int max);
@@ -96,7 +98,7 @@ class TidalService : public InternetService {
 
   void ClearSearch();
   void LoadSessionID();
-  QNetworkReply *CreateRequest(const QString &ressource_name, const QList<QPair<QString, QString>> &params);
+  QNetworkReply *CreateRequest(const QString &ressource_name, const QList<QPair<QString, QString>> &params, const bool cache = true);
   QByteArray GetReplyData(QNetworkReply *reply, QString &error, const bool sendlogin = false);
   QJsonObject ExtractJsonObj(QByteArray &data, QString &error);
   QJsonValue ExtractItems(QByteArray &data, QString &error);
@@ -113,7 +115,6 @@ class TidalService : public InternetService {
   QString Error(QString error, QVariant debug = QVariant());
 
   static const char *kApiUrl;
-  static const char *kAuthUrl;
   static const char *kResourcesUrl;
   static const char *kApiTokenB64;
   static const int kLoginAttempts;
@@ -122,9 +123,11 @@ class TidalService : public InternetService {
   Application *app_;
   NetworkAccessManager *network_;
   TidalUrlHandler *url_handler_;
+  TidalRequestCache *cache_;
   QTimer *timer_search_delay_;
   QTimer *timer_login_attempt_;
 
+  QString api_url_;
   QString username_;
   QString password_;
   QString quality_;
@@ -156,6 +159,7 @@ class TidalService : public InternetService {
   int artist_albums_received_;
   int album_songs_requested_;
   int album_songs_received_;
+  bool search_truncated_;
   SongList songs_;
   QString search_error_;
   bool login_sent_;
@@ -0,0 +1,240 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <iostream>
+#include <gst/gst.h>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QMetaObject>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QTimer>
+
+#include "core/closure.h"
+#include "core/commandlineoptions.h"
+#include "core/logging.h"
+#include "core/song.h"
+#include "core/tagreaderclient.h"
+#include "core/utilities.h"
+#include "organise/organiseformat.h"
+#include "batchtranscoder.h"
+#include "transcoder.h"
+
+const int BatchTranscoder::kMaxPendingTagReads = 20;
+const int BatchTranscoder::kTagReadTimeoutMsec = 60000;
+
+BatchTranscoder::BatchTranscoder(const CommandlineOptions &options, QObject *parent)
+    : QObject(parent),
+      input_(options.transcode_input()),
+      output_(options.transcode_output()),
+      preset_name_(options.transcode_preset()),
+      jobs_(options.transcode_jobs()),
+      format_(options.transcode_format()),
+      tag_reader_(nullptr),
+      transcoder_(nullptr),
+      tag_read_timer_(new QTimer(this)),
+      pending_tag_reads_(0),
+      queued_(0),
+      finished_(0),
+      transcoded_(0),
+      skipped_(0),
+      failed_(0) {
+
+  // Nothing else would end the run if the tagreader workers died or never started.
+  tag_read_timer_->setSingleShot(true);
+  tag_read_timer_->setInterval(kTagReadTimeoutMsec);
+  connect(tag_read_timer_, SIGNAL(timeout()), SLOT(TagReadTimedOut()));
+
+}
+
+bool BatchTranscoder::Start() {
+
+  if (!QFileInfo(input_).isDir()) {
+    Print(tr("%1 is not a directory").arg(input_));
+    return false;
+  }
+
+  if (output_.isEmpty()) {
+    Print(tr("No output directory given"));
+    return false;
+  }
+
+  if (!format_.IsValid()) {
+    Print(tr("Invalid format: %1").arg(format_.format()));
+    return false;
+  }
+
+  QStringList preset_names;
+  for (const TranscoderPreset &preset : Transcoder::GetAllPresets()) {
+    if (preset.name_.compare(preset_name_, Qt::CaseInsensitive) == 0) {
+      preset_ = preset;
+    }
+    preset_names << preset.name_;
+  }
+  if (preset_.type_ == Song::FileType_Unknown) {
+    Print(tr("Unknown preset \"%1\", available presets are: %2").arg(preset_name_, preset_names.join(", ")));
+    return false;
+  }
+
+  gst_init(nullptr, nullptr);
+
+  tag_reader_ = new TagReaderClient(this);
+  tag_reader_->Start();
+
+  transcoder_ = new Transcoder(this);
+  if (jobs_ > 0) transcoder_->set_max_threads(jobs_);
+  connect(transcoder_, SIGNAL(JobComplete(QString, QString, bool)), SLOT(JobComplete(QString, QString, bool)));
+
+  QDirIterator it(input_, QDir::Files | QDir::NoDotAndDotDot | QDir::Readable, QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    files_ << it.next();
+  }
+  files_.sort();
+
+  Print(tr("Found %1 files in %2").arg(files_.count()).arg(input_));
+
+  ReadMoreTags();
+
+  // There might be nothing to do at all, but we can only exit once the event loop is running
+  QMetaObject::invokeMethod(this, "MaybeFinish", Qt::QueuedConnection);
+
+  return true;
+
+}
+
+void BatchTranscoder::ReadMoreTags() {
+
+  // Keep a few tag reads in flight, the output filenames come from the tags
+  while (!files_.isEmpty() && pending_tag_reads_ < kMaxPendingTagReads) {
+    const QString filename = files_.takeFirst();
+    TagReaderReply *reply = tag_reader_->ReadFile(filename);
+    NewClosure(reply, SIGNAL(Finished(bool)), this, SLOT(TagsRead(TagReaderReply*, QString)), reply, filename);
+    ++pending_tag_reads_;
+  }
+
+  if (pending_tag_reads_ > 0 && !tag_read_timer_->isActive()) tag_read_timer_->start();
+
+}
+
+void BatchTranscoder::TagsRead(TagReaderReply *reply, const QString &filename) {
+
+  reply->deleteLater();
+  --pending_tag_reads_;
+
+  // The timeout is for the tagreader as a whole, so start over with every reply.
+  if (pending_tag_reads_ > 0) tag_read_timer_->start();
+  else tag_read_timer_->stop();
+
+  Song song;
+  song.InitFromProtobuf(reply->message().read_file_response().metadata());
+
+  // Not a music file
+  if (!song.is_valid() || song.filetype() == Song::FileType_Unknown) {
+    qLog(Debug) << "Skipping" << filename;
+    ReadMoreTags();
+    MaybeFinish();
+    return;
+  }
+
+  // Give the song the new type and extension so the format gives us the name of the transcoded file
+  song.set_filetype(preset_.type_);
+  song.set_url(QUrl::fromLocalFile(Utilities::FiddleFileExtension(song.url().toLocalFile(), preset_.extension_)));
+  song.set_basefilename(Utilities::FiddleFileExtension(song.basefilename(), preset_.extension_));
+
+  const QString output = output_ + "/" + format_.GetFilenameForSong(song);
+
+  // Skip files that were transcoded already and haven't changed since
+  QFileInfo output_info(output);
+  if (output_info.exists() && output_info.lastModified() >= QFileInfo(filename).lastModified()) {
+    ++skipped_;
+  }
+  else if (!QDir().mkpath(output_info.absolutePath())) {
+    Print(tr("Failed to create directory %1").arg(output_info.absolutePath()));
+    ++failed_;
+  }
+  else {
+    // Write to a temporary file first, so an interrupted run doesn't leave a file that looks up to date
+    transcoder_->AddJob(filename, preset_, output + ".part");
+    transcoder_->Start();
+    ++queued_;
+  }
+
+  ReadMoreTags();
+  MaybeFinish();
+
+}
+
+void BatchTranscoder::JobComplete(const QString &input, const QString &output, bool success) {
+
+  ++finished_;
+
+  // Strip the .part suffix
+  const QString final_output = output.left(output.length() - 5);
+  if (success) {
+    QFile::remove(final_output);
+    success = QFile::rename(output, final_output);
+  }
+
+  if (success) {
+    ++transcoded_;
+    Print(QString("[%1/%2] %3").arg(finished_).arg(queued_).arg(QDir::toNativeSeparators(final_output)));
+  }
+  else {
+    QFile::remove(output);
+    ++failed_;
+    Print(QString("[%1/%2] %3").arg(finished_).arg(queued_).arg(tr("Failed to transcode %1").arg(QDir::toNativeSeparators(input))));
+  }
+
+  MaybeFinish();
+
+}
+
+void BatchTranscoder::TagReadTimedOut() {
+
+  Print(tr("Timed out waiting for the tagreader, %1 files were not read").arg(pending_tag_reads_ + files_.count()));
+
+  QCoreApplication::exit(Exit_Failed);
+
+}
+
+void BatchTranscoder::MaybeFinish() {
+
+  if (!files_.isEmpty() || pending_tag_reads_ > 0 || finished_ < queued_) return;
+
+  Print(tr("Transcoded %1 files, %2 up to date, %3 failed").arg(transcoded_).arg(skipped_).arg(failed_));
+
+  QCoreApplication::exit(failed_ > 0 ? Exit_Failed : Exit_Success);
+
+}
+
+void BatchTranscoder::Print(const QString &message) {
+
+  std::cout << message.toLocal8Bit().constData() << std::endl;
+
+}
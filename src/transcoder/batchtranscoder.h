@@ -0,0 +1,90 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2019, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BATCHTRANSCODER_H
+#define BATCHTRANSCODER_H
+
+#include "config.h"
+
+#include <stdbool.h>
+
+#include <QObject>
+#include <QStringList>
+#include <QString>
+
+#include "core/tagreaderclient.h"
+#include "organise/organiseformat.h"
+#include "transcoder.h"
+
+class QTimer;
+class CommandlineOptions;
+
+// Transcodes a whole directory tree from the command line, without the user interface.
+// Files that already have an output file newer than the input are skipped, so running it again only transcodes what changed.
+class BatchTranscoder : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit BatchTranscoder(const CommandlineOptions &options, QObject *parent = nullptr);
+
+  enum ExitCode {
+    Exit_Success = 0,
+    Exit_Failed = 1,
+    Exit_InvalidArguments = 2,
+  };
+
+  // Checks the options and starts transcoding, the application exits with one of the exit codes above when finished.
+  // Returns false if the options are invalid.
+  bool Start();
+
+ private:
+  static const int kMaxPendingTagReads;
+  static const int kTagReadTimeoutMsec;
+
+  void ReadMoreTags();
+  void Print(const QString &message);
+
+ private slots:
+  void MaybeFinish();
+  void TagReadTimedOut();
+  void TagsRead(TagReaderReply *reply, const QString &filename);
+  void JobComplete(const QString &input, const QString &output, bool success);
+
+ private:
+  QString input_;
+  QString output_;
+  QString preset_name_;
+  int jobs_;
+
+  TranscoderPreset preset_;
+  OrganiseFormat format_;
+  TagReaderClient *tag_reader_;
+  Transcoder *transcoder_;
+  QTimer *tag_read_timer_;
+
+  QStringList files_;
+  int pending_tag_reads_;
+  int queued_;
+  int finished_;
+  int transcoded_;
+  int skipped_;
+  int failed_;
+};
+
+#endif  // BATCHTRANSCODER_H
@@ -47,6 +47,7 @@
 
 #include "core/logging.h"
 #include "core/signalchecker.h"
+#include "core/timeconstants.h"
 #include "core/utilities.h"
 #include "transcoder.h"
 
@@ -103,6 +104,54 @@ GstElement *Transcoder::CreateElementForMimeType(const QString &element_type, co
     return CreateElement("mp4mux", bin);
   }
 
+  const QString element_key = element_type + ":" + mime_type;
+  QString best_name = element_names_.value(element_key);
+  if (best_name.isNull()) {
+    best_name = FindElementForMimeType(element_type, mime_type);
+    element_names_.insert(element_key, best_name.isNull() ? QString("") : best_name);
+  }
+  if (best_name.isEmpty()) return nullptr;
+
+  if (best_name == "lamemp3enc") {
+    // Special case: we need to add xingmux and id3v2mux to the pipeline when using lamemp3enc because it doesn't write the VBR or ID3v2 headers itself.
+
+    emit LogLine("Adding xingmux and id3v2mux to the pipeline");
+
+    // Create the bin
+    GstElement *mp3bin = gst_bin_new("mp3bin");
+    gst_bin_add(GST_BIN(bin), mp3bin);
+
+    // Create the elements
+    GstElement *lame = CreateElement("lamemp3enc", mp3bin);
+    GstElement *xing = CreateElement("xingmux", mp3bin);
+    GstElement *id3v2 = CreateElement("id3v2mux", mp3bin);
+
+    if (!lame || !xing || !id3v2) {
+      return nullptr;
+    }
+
+    // Link the elements together
+    gst_element_link_many(lame, xing, id3v2, nullptr);
+
+    // Link the bin's ghost pads to the elements on each end
+    GstPad *pad = gst_element_get_static_pad(lame, "sink");
+    gst_element_add_pad(mp3bin, gst_ghost_pad_new("sink", pad));
+    gst_object_unref(GST_OBJECT(pad));
+
+    pad = gst_element_get_static_pad(id3v2, "src");
+    gst_element_add_pad(mp3bin, gst_ghost_pad_new("src", pad));
+    gst_object_unref(GST_OBJECT(pad));
+
+    return mp3bin;
+  }
+  else {
+    return CreateElement(best_name, bin);
+  }
+
+}
+
+QString Transcoder::FindElementForMimeType(const QString &element_type, const QString &mime_type) {
+
   // Keep track of all the suitable elements we find and figure out which is the best at the end.
   QList<SuitableElement> suitable_elements_;
 
@@ -146,7 +195,7 @@ GstElement *Transcoder::CreateElementForMimeType(const QString &element_type, co
   gst_plugin_feature_list_free(features);
   gst_caps_unref(target_caps);
 
-  if (suitable_elements_.isEmpty()) return nullptr;
+  if (suitable_elements_.isEmpty()) return QString();
 
   // Sort by rank
   std::sort(suitable_elements_.begin(), suitable_elements_.end());
@@ -154,41 +203,8 @@ GstElement *Transcoder::CreateElementForMimeType(const QString &element_type, co
 
   emit LogLine(QString("Using '%1' (rank %2)").arg(best.name_).arg(best.rank_));
 
-  if (best.name_ == "lamemp3enc") {
-    // Special case: we need to add xingmux and id3v2mux to the pipeline when using lamemp3enc because it doesn't write the VBR or ID3v2 headers itself.
-
-    emit LogLine("Adding xingmux and id3v2mux to the pipeline");
-
-    // Create the bin
-    GstElement *mp3bin = gst_bin_new("mp3bin");
-    gst_bin_add(GST_BIN(bin), mp3bin);
-
-    // Create the elements
-    GstElement *lame = CreateElement("lamemp3enc", mp3bin);
-    GstElement *xing = CreateElement("xingmux", mp3bin);
-    GstElement *id3v2 = CreateElement("id3v2mux", mp3bin);
-
-    if (!lame || !xing || !id3v2) {
-      return nullptr;
-    }
-
-    // Link the elements together
-    gst_element_link_many(lame, xing, id3v2, nullptr);
-
-    // Link the bin's ghost pads to the elements on each end
-    GstPad *pad = gst_element_get_static_pad(lame, "sink");
-    gst_element_add_pad(mp3bin, gst_ghost_pad_new("sink", pad));
-    gst_object_unref(GST_OBJECT(pad));
-
-    pad = gst_element_get_static_pad(id3v2, "src");
-    gst_element_add_pad(mp3bin, gst_ghost_pad_new("src", pad));
-    gst_object_unref(GST_OBJECT(pad));
+  return best.name_;
 
-    return mp3bin;
-  }
-  else {
-    return CreateElement(best.name_, bin);
-  }
 }
 
 Transcoder::JobFinishedEvent::JobFinishedEvent(JobState *state, bool success)
@@ -207,7 +223,9 @@ void Transcoder::JobState::PostFinished(bool success) {
 Transcoder::Transcoder(QObject *parent, const QString &settings_postfix)
     : QObject(parent),
     max_threads_(QThread::idealThreadCount()),
-    settings_postfix_(settings_postfix) {
+    settings_postfix_(settings_postfix),
+    finished_jobs_(0),
+    finished_duration_nanosec_(0) {
 
   if (JobFinishedEvent::sEventType == -1)
     JobFinishedEvent::sEventType = QEvent::registerEventType();
@@ -329,7 +347,11 @@ void Transcoder::AddJob(const QString &input, const TranscoderPreset &preset, co
   job.input = input;
   job.preset = preset;
   job.output = output;
-  queued_jobs_ << job;
+  job.size = QFileInfo(input).size();
+
+  // Keep the queue sorted by size, largest first.  Jobs of the same size keep the order they were added in.
+  QList<Job>::iterator it = std::upper_bound(queued_jobs_.begin(), queued_jobs_.end(), job, [](const Job &a, const Job &b) { return a.size > b.size; });
+  queued_jobs_.insert(it, job);
 
 }
 
@@ -337,6 +359,8 @@ void Transcoder::Start() {
 
   emit LogLine(tr("Transcoding %1 files using %2 threads").arg(queued_jobs_.count()).arg(max_threads()));
 
+  if (!elapsed_.isValid()) elapsed_.start();
+
   forever {
     StartJobStatus status = MaybeStartNextJob();
     if (status == AllThreadsBusy || status == NoMoreJobs) break;
@@ -349,6 +373,7 @@ Transcoder::StartJobStatus Transcoder::MaybeStartNextJob() {
   if (current_jobs_.count() >= max_threads()) return AllThreadsBusy;
   if (queued_jobs_.isEmpty()) {
     if (current_jobs_.isEmpty()) {
+      JobsFinished();
       emit AllJobsComplete();
     }
 
@@ -459,7 +484,9 @@ bool Transcoder::StartJob(const Job &job) {
   g_object_set(sink, "location", job.output.toUtf8().constData(), nullptr);
 
   // Set callbacks
+  state->src_element_ = src;
   state->convert_element_ = convert;
+  state->sink_element_ = sink;
 
   CHECKED_GCONNECT(decode, "pad-added", &NewPadCallback, state.get());
   gst_bus_set_sync_handler(gst_pipeline_get_bus(GST_PIPELINE(state->pipeline_)), BusCallbackSync, state.get(), nullptr);
@@ -500,20 +527,32 @@ bool Transcoder::event(QEvent *e) {
       return true;
     }
 
-    QString input = (*it)->job_.input;
-    QString output = (*it)->job_.output;
+    shared_ptr<JobState> state(*it);
+    QString input = state->job_.input;
+    QString output = state->job_.output;
+
+    if (finished_event->success_) {
+      gint64 duration = 0;
+      if (gst_element_query_duration(state->pipeline_, GST_FORMAT_TIME, &duration) && duration > 0) {
+        finished_duration_nanosec_ += duration;
+      }
+      ++finished_jobs_;
+    }
 
     // Remove event handlers from the gstreamer pipeline so they don't get called after the pipeline is shutting down
-    gst_bus_set_sync_handler(gst_pipeline_get_bus(GST_PIPELINE(finished_event->state_->pipeline_)), nullptr, nullptr, nullptr);
+    gst_bus_set_sync_handler(gst_pipeline_get_bus(GST_PIPELINE(state->pipeline_)), nullptr, nullptr, nullptr);
 
-    // Remove it from the list - this will also destroy the GStreamer pipeline
+    // Remove it from the list - the GStreamer pipeline is destroyed with the state unless it's used again below
     current_jobs_.erase(it);
 
     // Emit the finished signal
     emit JobComplete(input, output, finished_event->success_);
 
-    // Start some more jobs
-    MaybeStartNextJob();
+    // Start some more jobs, reusing this pipeline for the next one if we can
+    if (!finished_event->success_ || !ReuseJobState(state)) {
+      state.reset();
+      MaybeStartNextJob();
+    }
 
     return true;
   }
@@ -522,11 +561,69 @@ bool Transcoder::event(QEvent *e) {
 
 }
 
+bool Transcoder::ReuseJobState(shared_ptr<JobState> state) {
+
+  // Only take the job that is next in line anyway, so the largest files still go first
+  if (queued_jobs_.isEmpty() || current_jobs_.count() >= max_threads()) return false;
+
+  const TranscoderPreset &preset = state->job_.preset;
+  const TranscoderPreset &next_preset = queued_jobs_.first().preset;
+  if (next_preset.type_ != preset.type_ || next_preset.codec_mimetype_ != preset.codec_mimetype_ || next_preset.muxer_mimetype_ != preset.muxer_mimetype_) {
+    return false;
+  }
+
+  // Stopping the pipeline resets all the elements, the decoder adds a new pad for the next file when it's started again
+  if (gst_element_set_state(state->pipeline_, GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE) {
+    return false;
+  }
+
+  state->job_ = queued_jobs_.takeFirst();
+
+  emit LogLine(tr("Starting %1").arg(QDir::toNativeSeparators(state->job_.input)));
+
+  g_object_set(state->src_element_, "location", state->job_.input.toUtf8().constData(), nullptr);
+  g_object_set(state->sink_element_, "location", state->job_.output.toUtf8().constData(), nullptr);
+
+  gst_bus_set_sync_handler(gst_pipeline_get_bus(GST_PIPELINE(state->pipeline_)), BusCallbackSync, state.get(), nullptr);
+
+  if (gst_element_set_state(state->pipeline_, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    gst_bus_set_sync_handler(gst_pipeline_get_bus(GST_PIPELINE(state->pipeline_)), nullptr, nullptr, nullptr);
+    emit JobComplete(state->job_.input, state->job_.output, false);
+    return false;
+  }
+
+  current_jobs_ << state;
+
+  return true;
+
+}
+
+void Transcoder::JobsFinished() {
+
+  if (!elapsed_.isValid()) return;
+
+  const double seconds = elapsed_.elapsed() / 1000.0;
+  if (seconds > 0 && finished_jobs_ > 0) {
+    const double files_per_second = finished_jobs_ / seconds;
+    const double realtime_factor = (double(finished_duration_nanosec_) / kNsecPerSec) / seconds;
+    emit LogLine(tr("Transcoded %1 files in %2 seconds (%3 files/s, %4x realtime)").arg(finished_jobs_).arg(seconds, 0, 'f', 1).arg(files_per_second, 0, 'f', 2).arg(realtime_factor, 0, 'f', 1));
+  }
+
+  elapsed_.invalidate();
+  finished_jobs_ = 0;
+  finished_duration_nanosec_ = 0;
+
+}
+
 void Transcoder::Cancel() {
 
   // Remove all pending jobs
   queued_jobs_.clear();
 
+  elapsed_.invalidate();
+  finished_jobs_ = 0;
+  finished_duration_nanosec_ = 0;
+
   // Stop the running ones
   JobStateList::iterator it = current_jobs_.begin();
   while (it != current_jobs_.end()) {
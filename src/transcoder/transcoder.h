@@ -31,6 +31,8 @@
 #include <gst/gst.h>
 
 #include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QMetaType>
@@ -67,6 +69,7 @@ class Transcoder : public QObject {
   void set_max_threads(int count) { max_threads_ = count; }
 
   QString GetFile(const QString &input, const TranscoderPreset &preset, const QString output = QString());
+  // Jobs are started largest input file first, so a few long files don't end up running on their own at the end.
   void AddJob(const QString &input, const TranscoderPreset &preset, const QString &output);
 
   QMap<QString, float> GetProgress() const;
@@ -87,9 +90,11 @@ class Transcoder : public QObject {
  private:
   // The description of a file to transcode - lives in the main thread.
   struct Job {
+    Job() : size(0) {}
     QString input;
     QString output;
     TranscoderPreset preset;
+    qint64 size;
   };
 
   // State held by a job and shared across gstreamer callbacks - lives in the job's thread.
@@ -98,7 +103,9 @@ class Transcoder : public QObject {
         : job_(job),
           parent_(parent),
           pipeline_(nullptr),
-          convert_element_(nullptr) {}
+          src_element_(nullptr),
+          convert_element_(nullptr),
+          sink_element_(nullptr) {}
     ~JobState();
 
     void PostFinished(bool success);
@@ -107,7 +114,9 @@ class Transcoder : public QObject {
     Job job_;
     Transcoder *parent_;
     GstElement *pipeline_;
+    GstElement *src_element_;
     GstElement *convert_element_;
+    GstElement *sink_element_;
   };
 
   // Event passed from a GStreamer callback to the Transcoder when a job finishes.
@@ -129,9 +138,12 @@ class Transcoder : public QObject {
 
   StartJobStatus MaybeStartNextJob();
   bool StartJob(const Job &job);
+  bool ReuseJobState(std::shared_ptr<JobState> state);
+  void JobsFinished();
 
   GstElement *CreateElement(const QString &factory_name, GstElement *bin = nullptr, const QString &name = QString());
   GstElement *CreateElementForMimeType(const QString &element_type, const QString &mime_type, GstElement *bin = nullptr);
+  QString FindElementForMimeType(const QString &element_type, const QString &mime_type);
   void SetElementProperties(const QString &name, GObject *element);
 
   static void NewPadCallback(GstElement*, GstPad *pad, gpointer data);
@@ -144,6 +156,14 @@ class Transcoder : public QObject {
   QList<Job> queued_jobs_;
   JobStateList current_jobs_;
   QString settings_postfix_;
+
+  // Element factory names found for each element type and mime type, so the registry is only searched once.
+  QHash<QString, QString> element_names_;
+
+  // Throughput since the first job was started
+  QElapsedTimer elapsed_;
+  int finished_jobs_;
+  qint64 finished_duration_nanosec_;
 };
 
 #endif  // TRANSCODER_H